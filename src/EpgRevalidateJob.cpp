@@ -0,0 +1,52 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "client.h" //for XBMC->Log
+#include "epgcache.h"
+#include "EpgRevalidateJob.h"
+
+using namespace ADDON;
+
+CEpgRevalidateJob::CEpgRevalidateJob(cEpgCache& cache) :
+  CScheduledJob("epg revalidation", true),
+  m_cache(cache),
+  m_channels(0)
+{
+  XBMC->Log(LOG_DEBUG, "CEpgRevalidateJob:: constructor");
+}
+
+CEpgRevalidateJob::~CEpgRevalidateJob(void)
+{
+  XBMC->Log(LOG_DEBUG, "CEpgRevalidateJob:: destructor");
+}
+
+int CEpgRevalidateJob::Run()
+{
+  // One guide channel per run, so the other jobs get their turn in between
+  if (m_cache.RevalidateNext())
+  {
+    m_channels++;
+    return 0;
+  }
+  XBMC->Log(LOG_DEBUG, "CEpgRevalidateJob:: %d guide channel(s) revalidated", m_channels);
+  m_channels = 0;
+  return -1;
+}
@@ -0,0 +1,41 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "Scheduler.h"
+
+class cEpgCache;
+
+/**
+ * \brief Refetches the guide data that was loaded from the EPG cache file, one guide channel per run
+ */
+class CEpgRevalidateJob : public CScheduledJob
+{
+public:
+  CEpgRevalidateJob(cEpgCache& cache);
+  virtual ~CEpgRevalidateJob(void);
+
+  virtual int Run(void);
+
+private:
+  cEpgCache& m_cache;
+  int m_channels;
+};
@@ -0,0 +1,188 @@
+/*
+ *      Copyright (C) 2014 Fred Hoogduin
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+#include <algorithm>
+#include "client.h" //for XBMC->Log
+#include "argustvrpc.h"
+#include "EventsJob.h"
+#include "pvrclient-argustv.h"
+
+using namespace ADDON;
+
+// Poll interval when there are no events
+#define EVENTS_INTERVAL 10000
+// Poll interval right after events arrived; more events often follow
+#define EVENTS_BUSY_INTERVAL 2000
+// Longest interval between polls or subscription attempts when the server does not answer
+#define EVENTS_MAX_INTERVAL 60000
+
+CEventsJob::CEventsJob(cPVRClientArgusTV* client) :
+  CScheduledJob("events", true),
+  m_client(client),
+  m_subscribed(false),
+  m_interval(EVENTS_INTERVAL)
+{
+  XBMC->Log(LOG_DEBUG, "CEventsJob:: constructor");
+}
+
+
+CEventsJob::~CEventsJob(void)
+{
+  XBMC->Log(LOG_DEBUG, "CEventsJob:: destructor");
+  // v17 Krypton. When exiting Kodi with this addon still subscribed,
+  // network services are already unavailable. ArgusTV::UnsubscribeServiceEvents won't succeed
+}
+
+void CEventsJob::Connect()
+{
+  XBMC->Log(LOG_DEBUG, "CEventsJob::Connect");
+  // Subscribe to service events
+  Json::Value response;
+  int retval = ArgusTV::SubscribeServiceEvents(ArgusTV::AllEvents, response);
+  if (retval >= 0)
+  {
+    m_monitorId = response.asString();
+    m_subscribed = true;
+    XBMC->Log(LOG_DEBUG, "CEventsJob:: monitorId = %s", m_monitorId.c_str());
+  }
+  else
+  {
+    m_subscribed = false;
+    XBMC->Log(LOG_NOTICE, "CEventsJob:: subscribe to events failed");
+  }
+}
+
+int CEventsJob::Run()
+{
+  if (!m_subscribed)
+  {
+    Connect();
+    if (!m_subscribed)
+    {
+      m_interval = std::min(m_interval * 2, EVENTS_MAX_INTERVAL);
+      return m_interval;
+    }
+  }
+
+  // Get service events
+  Json::Value response;
+  int retval = ArgusTV::GetServiceEvents(m_monitorId, response);
+  if (retval < 0)
+  {
+    m_interval = std::min(m_interval * 2, EVENTS_MAX_INTERVAL);
+  }
+  else if (response["Expired"].asBool())
+  {
+    // events may have been missed
+    m_client->OnRecordingChanged("");
+    m_client->OnTimersChanged();
+    ArgusTV::ClearEmptySchedule();
+    // refresh subscription
+    Connect();
+    m_interval = EVENTS_BUSY_INTERVAL;
+  }
+  else
+  {
+    // Process service events
+    Json::Value events = response["Events"];
+    if (events.size() > 0u)
+    {
+      HandleEvents(events);
+      m_interval = EVENTS_BUSY_INTERVAL;
+    }
+    else
+    {
+      m_interval = std::min(m_interval * 2, EVENTS_INTERVAL);
+    }
+  }
+  return m_interval;
+}
+
+void CEventsJob::HandleEvents(Json::Value events)
+{
+  XBMC->Log(LOG_DEBUG, "CEventsJob::HandleEvents");
+  int size = events.size();
+  bool mustUpdateTimers = false;
+  bool mustUpdateRecordings = false;
+  bool mustUpdateGuide = false;
+  bool mustClearTemplates = false;
+  std::vector<std::string> changedRecordings;
+  // Aggregate events
+  for (int i = 0; i < size; i++)
+  {
+    Json::Value event = events[i];
+    std::string eventName = event["Name"].asString();
+    XBMC->Log(LOG_DEBUG, "CEventsJob:: ARGUS TV reports event %s", eventName.c_str());
+    if (eventName == "UpcomingRecordingsChanged")
+    {
+      XBMC->Log(LOG_DEBUG, "Timers changed");
+      mustUpdateTimers = true;
+    }
+    else if (eventName == "RecordingStarted" || eventName == "RecordingEnded")
+    {
+      XBMC->Log(LOG_DEBUG, "Recordings changed");
+      mustUpdateRecordings = true;
+      // The matching timer starts or stops recording
+      mustUpdateTimers = true;
+      // The argument is the recording; without its id everything is refetched
+      std::string recordingId;
+      Json::Value arguments = event["Arguments"];
+      if (arguments.isArray() && arguments.size() > 0u && arguments[0u].isObject())
+        recordingId = arguments[0u]["RecordingId"].asString();
+      if (std::find(changedRecordings.begin(), changedRecordings.end(), recordingId) == changedRecordings.end())
+        changedRecordings.push_back(recordingId);
+    }
+    else if (eventName == "NewGuideData")
+    {
+      XBMC->Log(LOG_DEBUG, "Guide data changed");
+      mustUpdateGuide = true;
+    }
+    else if (eventName == "ConfigurationChanged")
+    {
+      XBMC->Log(LOG_DEBUG, "Configuration changed");
+      mustClearTemplates = true;
+    }
+  }
+  // Handle aggregated events
+  if (mustUpdateTimers)
+  {
+    XBMC->Log(LOG_DEBUG, "CEventsJob:: Timers update triggered");
+    m_client->OnTimersChanged();
+    PVR->TriggerTimerUpdate();
+  }
+  if (mustUpdateRecordings)
+  {
+    XBMC->Log(LOG_DEBUG, "CEventsJob:: Recordings update triggered");
+    for (std::vector<std::string>::const_iterator it = changedRecordings.begin(); it != changedRecordings.end(); ++it)
+      m_client->OnRecordingChanged(*it);
+    PVR->TriggerRecordingUpdate();
+  }
+  if (mustUpdateGuide)
+  {
+    XBMC->Log(LOG_DEBUG, "CEventsJob:: Guide cache invalidated");
+    m_client->OnGuideDataChanged();
+  }
+  if (mustClearTemplates)
+  {
+    XBMC->Log(LOG_DEBUG, "CEventsJob:: Empty schedule template cleared");
+    ArgusTV::ClearEmptySchedule();
+  }
+}
@@ -19,20 +19,30 @@
  *
  */
 
-#include "p8-platform/threads/threads.h"
+#include <string>
+#include "Scheduler.h"
 
-class CEventsThread : public P8PLATFORM::CThread
+class cPVRClientArgusTV;
+
+/**
+ * \brief Polls the service events of the server. The poll interval shortens while events
+ *        arrive and grows back to EVENTS_INTERVAL when it is quiet.
+ */
+class CEventsJob : public CScheduledJob
 {
 public:
-  CEventsThread(void);
-  ~CEventsThread(void);
+  CEventsJob(cPVRClientArgusTV* client);
+  ~CEventsJob(void);
   void Connect(void);
-private:
-  virtual void *Process(void);
 
+  virtual int Run(void);
+
+private:
   void HandleEvents(Json::Value events);
 
+  cPVRClientArgusTV* m_client;
   bool m_subscribed;
   std::string m_monitorId;
+  int m_interval;
 };
 
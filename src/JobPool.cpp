@@ -0,0 +1,146 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "client.h" //for XBMC->Log
+#include "JobPool.h"
+#include <algorithm> //std::min
+
+using namespace ADDON;
+using namespace P8PLATFORM;
+
+CJobPool::CJobPool(unsigned int maxThreads) :
+  m_maxThreads(maxThreads),
+  m_jobs(NULL),
+  m_nextJob(0),
+  m_jobsDone(0),
+  m_bAllDone(true),
+  m_bWorkAvailable(false),
+  m_bStopping(false)
+{
+}
+
+CJobPool::~CJobPool(void)
+{
+  for (std::vector<CWorker*>::iterator it = m_workers.begin(); it != m_workers.end(); ++it)
+    (*it)->StopThread(-1);
+  {
+    CLockObject lock(m_mutex);
+    m_bStopping = true;
+    m_bWorkAvailable = true;
+    m_workCondition.Broadcast();
+  }
+  for (std::vector<CWorker*>::iterator it = m_workers.begin(); it != m_workers.end(); ++it)
+  {
+    (*it)->StopThread();
+    delete *it;
+  }
+}
+
+void CJobPool::StartWorkers(size_t count)
+{
+  // The calling thread is one of the workers, so start one thread less
+  for (size_t i = m_workers.size() + 1; i < count; i++)
+  {
+    CWorker* worker = new CWorker(*this);
+    if (worker->CreateThread(false))
+    {
+      m_workers.push_back(worker);
+    }
+    else
+    {
+      XBMC->Log(LOG_ERROR, "CJobPool:: could not start worker thread %d.", (int) i);
+      delete worker;
+      break;
+    }
+  }
+}
+
+void CJobPool::Run(const std::vector<CJob*>& jobs)
+{
+  CLockObject runlock(m_runMutex);
+
+  if (jobs.empty())
+    return;
+
+  if (jobs.size() > 1)
+    StartWorkers(std::min((size_t) m_maxThreads, jobs.size()));
+
+  {
+    CLockObject lock(m_mutex);
+    m_jobs = &jobs;
+    m_nextJob = 0;
+    m_jobsDone = 0;
+    m_bAllDone = false;
+    m_bWorkAvailable = true;
+    m_workCondition.Broadcast();
+  }
+
+  RunJobs();
+
+  CLockObject lock(m_mutex);
+  m_condition.Wait(m_mutex, m_bAllDone);
+  m_jobs = NULL;
+}
+
+CJob* CJobPool::NextJob(void)
+{
+  CLockObject lock(m_mutex);
+  if (m_jobs == NULL || m_nextJob >= m_jobs->size())
+    return NULL;
+  if (m_nextJob + 1 == m_jobs->size() && !m_bStopping)
+    m_bWorkAvailable = false;
+  return (*m_jobs)[m_nextJob++];
+}
+
+void CJobPool::JobDone(void)
+{
+  CLockObject lock(m_mutex);
+  if (++m_jobsDone == m_jobs->size())
+  {
+    m_bAllDone = true;
+    m_condition.Broadcast();
+  }
+}
+
+void CJobPool::RunJobs(void)
+{
+  CJob* job;
+  while ((job = NextJob()) != NULL)
+  {
+    job->Run();
+    JobDone();
+  }
+}
+
+void *CJobPool::CWorker::Process(void)
+{
+  while (!IsStopped())
+  {
+    {
+      CLockObject lock(m_pool.m_mutex);
+      m_pool.m_workCondition.Wait(m_pool.m_mutex, m_pool.m_bWorkAvailable);
+    }
+    if (IsStopped())
+      break;
+    m_pool.RunJobs();
+  }
+  return NULL;
+}
@@ -0,0 +1,157 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <algorithm>
+#include <vector>
+#include "p8-platform/threads/threads.h"
+
+/**
+ * \brief A unit of work that can be executed by a CJobPool
+ */
+class CJob
+{
+public:
+  virtual ~CJob(void) {}
+  virtual void Run(void) = 0;
+};
+
+/**
+ * \brief Runs a batch of independent jobs on a small number of worker threads
+ *        and waits for all of them to finish. The calling thread takes part in the work.
+ *        The workers are started by the first Run() and wait for the next batch until the
+ *        pool is destroyed, so running many small batches does not start threads each time.
+ */
+class CJobPool
+{
+public:
+  CJobPool(unsigned int maxThreads);
+  virtual ~CJobPool(void);
+
+  void Run(const std::vector<CJob*>& jobs);
+
+  unsigned int MaxThreads(void) const { return m_maxThreads; }
+
+private:
+  class CWorker : public P8PLATFORM::CThread
+  {
+  public:
+    CWorker(CJobPool& pool) : m_pool(pool) {}
+  private:
+    virtual void *Process(void);
+    CJobPool& m_pool;
+  };
+
+  void StartWorkers(size_t count);
+  CJob* NextJob(void);
+  void JobDone(void);
+  void RunJobs(void);
+
+  unsigned int m_maxThreads;
+  P8PLATFORM::CMutex m_runMutex;   // one batch at a time
+  P8PLATFORM::CMutex m_mutex;      // protects the batch administration below
+  P8PLATFORM::CCondition<bool> m_condition;      // signals m_bAllDone
+  P8PLATFORM::CCondition<bool> m_workCondition;  // signals m_bWorkAvailable
+  std::vector<CWorker*> m_workers;
+  const std::vector<CJob*>* m_jobs;
+  size_t m_nextJob;
+  size_t m_jobsDone;
+  bool m_bAllDone;
+  bool m_bWorkAvailable; // the batch has jobs that were not handed out yet, or the pool stops
+  bool m_bStopping;
+};
+
+/**
+ * \brief Converts a vector of parsed objects into Kodi structs on a job pool and hands the
+ *        results to Transfer() in the original order. The work is done in batches, so only
+ *        threads * chunksize converted structs exist at a time. Small inputs are converted
+ *        on the calling thread. Convert() must be safe to call from several threads at once.
+ *        The pool is shared with other converters; it runs one batch at a time.
+ */
+template <typename Source, typename Target>
+class CParallelConverter
+{
+public:
+  CParallelConverter(CJobPool& pool, size_t chunksize = 64, size_t threshold = 256) :
+    m_pool(pool), m_threads(pool.MaxThreads()), m_chunksize(chunksize), m_threshold(threshold) {}
+  virtual ~CParallelConverter(void) {}
+
+  void Run(std::vector<Source>& sources)
+  {
+    if (sources.size() < m_threshold || m_threads <= 1)
+    {
+      Target target;
+      for (size_t index = 0; index < sources.size(); index++)
+      {
+        Convert(sources[index], target, index);
+        Transfer(target);
+      }
+      return;
+    }
+
+    std::vector<Target> targets(m_threads * m_chunksize);
+    for (size_t batch = 0; batch < sources.size(); batch += targets.size())
+    {
+      size_t count = std::min(targets.size(), sources.size() - batch);
+      std::vector<CJob*> jobs;
+      for (size_t offset = 0; offset < count; offset += m_chunksize)
+        jobs.push_back(new CChunkJob(*this, sources, targets, batch, offset, std::min(m_chunksize, count - offset)));
+      m_pool.Run(jobs);
+      for (std::vector<CJob*>::iterator it = jobs.begin(); it != jobs.end(); ++it)
+        delete *it;
+
+      for (size_t index = 0; index < count; index++)
+        Transfer(targets[index]);
+    }
+  }
+
+protected:
+  virtual void Convert(Source& source, Target& target, size_t index) = 0;
+  virtual void Transfer(const Target& target) = 0;
+
+private:
+  class CChunkJob : public CJob
+  {
+  public:
+    CChunkJob(CParallelConverter& converter, std::vector<Source>& sources, std::vector<Target>& targets,
+      size_t batch, size_t offset, size_t count) :
+      m_converter(converter), m_sources(sources), m_targets(targets), m_batch(batch), m_offset(offset), m_count(count) {}
+
+    virtual void Run(void)
+    {
+      for (size_t i = m_offset; i < m_offset + m_count; i++)
+        m_converter.Convert(m_sources[m_batch + i], m_targets[i], m_batch + i);
+    }
+
+  private:
+    CParallelConverter& m_converter;
+    std::vector<Source>& m_sources;
+    std::vector<Target>& m_targets;
+    size_t m_batch;
+    size_t m_offset;
+    size_t m_count;
+  };
+
+  CJobPool& m_pool;
+  unsigned int m_threads;
+  size_t m_chunksize;
+  size_t m_threshold;
+};
@@ -0,0 +1,79 @@
+/*
+ *      Copyright (C) 2010 Marcel Groothuis
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <algorithm>
+#include "p8-platform/os.h"
+#include "p8-platform/util/timeutils.h"
+#include "client.h" //for XBMC->Log
+#include "utils.h"
+#include "argustvrpc.h"
+#include "KeepAliveJob.h"
+
+using namespace ADDON;
+
+// Age of StreamLastAliveTime at which the stream is due a keepalive for sure ("every 30 seconds or so")
+#define KEEPALIVE_WINDOW 30000
+// Interval of the keepalives while the server confirms them
+#define KEEPALIVE_INTERVAL (KEEPALIVE_WINDOW / 3)
+// First retry after a failed keepalive, doubled on every next failure
+#define KEEPALIVE_RETRY 1000
+
+CKeepAliveJob::CKeepAliveJob() :
+  CScheduledJob("keepalive"),
+  m_retryInterval(KEEPALIVE_RETRY)
+{
+  XBMC->Log(LOG_DEBUG, "CKeepAliveJob:: constructor");
+}
+
+CKeepAliveJob::~CKeepAliveJob()
+{
+  XBMC->Log(LOG_DEBUG, "CKeepAliveJob:: destructor");
+}
+
+unsigned int CKeepAliveJob::FirstInterval(void)
+{
+  m_retryInterval = KEEPALIVE_RETRY;
+
+  // An age outside the window means the clocks of client and server differ, then count from now
+  time_t alive = ArgusTV::GetLiveStreamLastAliveTime();
+  int64_t age = (int64_t) (time(NULL) - alive) * 1000;
+  if (alive == 0 || age < 0 || age >= KEEPALIVE_WINDOW)
+    age = 0;
+  XBMC->Log(LOG_DEBUG, "CKeepAliveJob:: stream was alive %d ms ago", (int) age);
+  return (unsigned int) std::max((int64_t) KEEPALIVE_RETRY, KEEPALIVE_INTERVAL - age);
+}
+
+int CKeepAliveJob::Run()
+{
+  // The server stamps the stream when it handles the call, so the call's own duration counts
+  int64_t start = P8PLATFORM::GetTimeMs();
+  bool retval = ArgusTV::KeepLiveStreamAlive();
+  int64_t duration = P8PLATFORM::GetTimeMs() - start;
+  XBMC->Log(LOG_DEBUG, "CKeepAliveJob:: KeepLiveStreamAlive returned %i after %d ms", (int) retval, (int) duration);
+  if (retval)
+  {
+    m_retryInterval = KEEPALIVE_RETRY;
+    return (int) std::max((int64_t) KEEPALIVE_RETRY, KEEPALIVE_INTERVAL - duration);
+  }
+  // Retry before the server gives up on the stream
+  int next = (int) m_retryInterval;
+  m_retryInterval = std::min(m_retryInterval * 2, (unsigned int) KEEPALIVE_INTERVAL);
+  return next;
+}
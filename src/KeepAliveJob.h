@@ -0,0 +1,44 @@
+#pragma once
+/*
+ *      Copyright (C) 2010 Marcel Groothuis
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include "Scheduler.h"
+
+/**
+ * \brief Tells the server that the live stream is still watched. The server stamps the stream
+ *        with StreamLastAliveTime on every sign of life, the tune included, and a keepalive is
+ *        sent a third of KEEPALIVE_WINDOW after the last stamp, so two calls can fail before the
+ *        window is over. Failed calls are retried sooner.
+ */
+class CKeepAliveJob : public CScheduledJob
+{
+public:
+  CKeepAliveJob();
+  virtual ~CKeepAliveJob(void);
+
+  /**
+   * \brief Milliseconds from now to the first keepalive of a stream that was just tuned, counted
+   *        from the StreamLastAliveTime the server reported; tuning can take several seconds
+   */
+  unsigned int FirstInterval(void);
+
+  virtual int Run(void);
+
+private:
+  unsigned int m_retryInterval;
+};
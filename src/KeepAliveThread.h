@@ -1,29 +0,0 @@
-#pragma once
-/*
- *      Copyright (C) 2010 Marcel Groothuis
- *
- *  This program is free software: you can redistribute it and/or modify
- *  it under the terms of the GNU General Public License as published by
- *  the Free Software Foundation, either version 2 of the License, or
- *  (at your option) any later version.
- *
- *  This program is distributed in the hope that it will be useful,
- *  but WITHOUT ANY WARRANTY; without even the implied warranty of
- *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- *  GNU General Public License for more details.
- *
- *  You should have received a copy of the GNU General Public License
- *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
- */
-
-#include "p8-platform/threads/threads.h"
-
-class CKeepAliveThread : public P8PLATFORM::CThread
-{
-public:
-  CKeepAliveThread();
-  virtual ~CKeepAliveThread(void);
-private:
-  virtual void *Process(void);
-};
-
@@ -0,0 +1,141 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <algorithm>
+#include "client.h" //for XBMC->Log
+#include "utils.h"
+#include "argustvrpc.h"
+#include "recordingcache.h"
+#include "RecordingDeleteJob.h"
+#include "JobPool.h"
+
+using namespace ADDON;
+using namespace P8PLATFORM;
+
+#define RECORDING_DELETE_THREADS 4
+#define RECORDING_DELETE_BATCH   16
+
+namespace
+{
+  class CDeleteRecordingJob : public CJob
+  {
+  public:
+    CDeleteRecordingJob(const std::string& filename) : m_filename(filename), m_bSuccess(false) {}
+
+    virtual void Run(void)
+    {
+      // JSONify the stream_url
+      Json::Value recordingname (ToUNC(m_filename.c_str()));
+      Json::FastWriter writer;
+      std::string jsonval = writer.write(recordingname);
+      m_bSuccess = (ArgusTV::DeleteRecording(jsonval) >= 0);
+    }
+
+    bool Success(void) const { return m_bSuccess; }
+
+  private:
+    std::string m_filename;
+    bool m_bSuccess;
+  };
+}
+
+CRecordingDeleteJob::CRecordingDeleteJob(CScheduler& scheduler, cRecordingCache& cache) :
+  CScheduledJob("recording deletions", true),
+  m_scheduler(scheduler),
+  m_cache(cache)
+{
+  XBMC->Log(LOG_DEBUG, "CRecordingDeleteJob:: constructor");
+}
+
+CRecordingDeleteJob::~CRecordingDeleteJob(void)
+{
+  XBMC->Log(LOG_DEBUG, "CRecordingDeleteJob:: destructor");
+}
+
+void CRecordingDeleteJob::Delete(const std::string& recordingid, const std::string& filename)
+{
+  Deletion deletion;
+  deletion.recordingid = recordingid;
+  deletion.filename = filename;
+  deletion.cached = m_cache.RemoveRecording(recordingid, &deletion.recording);
+
+  {
+    CLockObject lock(m_mutex);
+    m_queue.push_back(deletion);
+  }
+  m_scheduler.Schedule(this, 0);
+}
+
+void CRecordingDeleteJob::Flush(void)
+{
+  while (ProcessQueue())
+    ;
+}
+
+bool CRecordingDeleteJob::ProcessQueue(void)
+{
+  std::vector<Deletion> deletions;
+  {
+    CLockObject lock(m_mutex);
+    size_t count = std::min(m_queue.size(), (size_t) RECORDING_DELETE_BATCH);
+    deletions.assign(m_queue.begin(), m_queue.begin() + count);
+    m_queue.erase(m_queue.begin(), m_queue.begin() + count);
+  }
+  if (deletions.empty())
+    return false;
+
+  std::vector<CJob*> jobs;
+  for (std::vector<Deletion>::const_iterator it = deletions.begin(); it != deletions.end(); ++it)
+    jobs.push_back(new CDeleteRecordingJob(it->filename));
+
+  CJobPool pool(RECORDING_DELETE_THREADS);
+  pool.Run(jobs);
+
+  int failures = 0;
+  for (size_t i = 0; i < deletions.size(); i++)
+  {
+    bool bSuccess = static_cast<CDeleteRecordingJob*>(jobs[i])->Success();
+    m_cache.DeleteDone(deletions[i].recordingid, bSuccess, deletions[i].cached ? &deletions[i].recording : NULL);
+    if (!bSuccess)
+    {
+      XBMC->Log(LOG_ERROR, "Deleting recording %s failed.", deletions[i].filename.c_str());
+      failures++;
+    }
+    delete jobs[i];
+  }
+  XBMC->Log(LOG_DEBUG, "CRecordingDeleteJob:: deleted %d of %d recordings", (int) deletions.size() - failures, (int) deletions.size());
+
+  if (failures > 0)
+  {
+    XBMC->QueueNotification(QUEUE_ERROR, "%d recording(s) could not be deleted", failures);
+    PVR->TriggerRecordingUpdate();
+  }
+
+  // More queued than fit in one batch
+  CLockObject lock(m_mutex);
+  return !m_queue.empty();
+}
+
+int CRecordingDeleteJob::Run()
+{
+  // Run again right away while more is queued than fit in one batch
+  return ProcessQueue() ? 0 : -1;
+}
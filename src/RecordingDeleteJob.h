@@ -0,0 +1,71 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <string>
+#include <vector>
+#include "p8-platform/threads/mutex.h"
+#include "recording.h"
+#include "Scheduler.h"
+
+class cRecordingCache;
+
+/**
+ * \brief Deletes recordings on the server in the background. The recordings are removed
+ *        from the recordings cache right away and put back when the server reports an error.
+ *        The job is scheduled when a deletion is queued and runs until the queue is empty.
+ */
+class CRecordingDeleteJob : public CScheduledJob
+{
+public:
+  CRecordingDeleteJob(CScheduler& scheduler, cRecordingCache& cache);
+  virtual ~CRecordingDeleteJob(void);
+
+  /**
+   * \brief Queue a recording for deletion
+   * \param filename Recording file name as handed to Kodi
+   */
+  void Delete(const std::string& recordingid, const std::string& filename);
+
+  /**
+   * \brief Process the queued deletions from the calling thread. Used at shutdown, after the job
+   *        was cancelled.
+   */
+  void Flush(void);
+
+  virtual int Run(void);
+
+private:
+  struct Deletion
+  {
+    std::string recordingid;
+    std::string filename;
+    bool cached;          // the recording was in the cache and can be restored
+    cRecording recording;
+  };
+
+  bool ProcessQueue(void);
+
+  CScheduler& m_scheduler;
+  cRecordingCache& m_cache;
+  P8PLATFORM::CMutex m_mutex;
+  std::vector<Deletion> m_queue;
+};
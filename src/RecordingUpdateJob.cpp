@@ -0,0 +1,224 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <algorithm>
+#include <vector>
+#include "client.h" //for XBMC->Log
+#include "utils.h"
+#include "argustvrpc.h"
+#include "recordingcache.h"
+#include "RecordingUpdateJob.h"
+#include "p8-platform/util/timeutils.h"
+
+using namespace ADDON;
+using namespace P8PLATFORM;
+
+#define RECORDING_UPDATE_DELAY       2000  // ms after the last change before it is sent
+#define RECORDING_UPDATE_RETRY_DELAY 1000  // ms before the first retry, doubled after each failure
+#define RECORDING_UPDATE_MAX_RETRIES 6
+
+CRecordingUpdateJob::CRecordingUpdateJob(CScheduler& scheduler, cRecordingCache& cache) :
+  CScheduledJob("recording updates", true),
+  m_scheduler(scheduler),
+  m_cache(cache),
+  m_scheduledAt(0)
+{
+  XBMC->Log(LOG_DEBUG, "CRecordingUpdateJob:: constructor");
+}
+
+CRecordingUpdateJob::~CRecordingUpdateJob(void)
+{
+  XBMC->Log(LOG_DEBUG, "CRecordingUpdateJob:: destructor");
+}
+
+void CRecordingUpdateJob::SetLastWatchedPosition(const std::string& filename, int position)
+{
+  Update update;
+  update.hasPosition = true;
+  update.position = position;
+  Queue(filename, update);
+}
+
+void CRecordingUpdateJob::SetFullyWatchedCount(const std::string& filename, int playcount)
+{
+  Update update;
+  update.hasPlaycount = true;
+  update.playcount = playcount;
+  Queue(filename, update);
+}
+
+void CRecordingUpdateJob::Queue(const std::string& filename, const Update& update)
+{
+  CLockObject lock(m_mutex);
+  Update& pending = m_updates[filename];
+  if (update.hasPosition)
+  {
+    pending.hasPosition = true;
+    pending.position = update.position;
+  }
+  if (update.hasPlaycount)
+  {
+    pending.hasPlaycount = true;
+    pending.playcount = update.playcount;
+  }
+  pending.attempts = 0;
+  int64_t now = GetTimeMs();
+  pending.due = now + RECORDING_UPDATE_DELAY;
+
+  // Only move the job forward, a retry of another recording may be due earlier
+  int64_t due = NextDue();
+  if (m_scheduledAt == 0 || due < m_scheduledAt)
+  {
+    m_scheduledAt = due;
+    lock.Unlock();
+    m_scheduler.Schedule(this, (unsigned int) std::max((int64_t) 0, due - now));
+  }
+}
+
+void CRecordingUpdateJob::FlushAsync(void)
+{
+  {
+    CLockObject lock(m_mutex);
+    if (m_updates.empty())
+      return;
+    for (std::map<std::string, Update>::iterator it = m_updates.begin(); it != m_updates.end(); ++it)
+      it->second.due = 0;
+    m_scheduledAt = GetTimeMs();
+  }
+  m_scheduler.Schedule(this, 0);
+}
+
+void CRecordingUpdateJob::Flush(void)
+{
+  SendDue(true, false);
+}
+
+bool CRecordingUpdateJob::Send(const std::string& filename, const Update& update)
+{
+  // JSONify the stream_url
+  Json::Value recordingname (ToUNC(filename.c_str()));
+  Json::FastWriter writer;
+  std::string jsonval = writer.write(recordingname);
+
+  if (update.hasPosition && ArgusTV::SetRecordingLastWatchedPosition(jsonval, update.position) < 0)
+  {
+    XBMC->Log(LOG_INFO, "Failed to set recording last watched position of %s", filename.c_str());
+    return false;
+  }
+  if (update.hasPlaycount && ArgusTV::SetRecordingFullyWatchedCount(jsonval, update.playcount) < 0)
+  {
+    XBMC->Log(LOG_INFO, "Failed to set recording play count of %s", filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+void CRecordingUpdateJob::Done(const std::string& filename, const Update& update)
+{
+  m_cache.WriteDone(filename, update.hasPosition ? &update.position : NULL, update.hasPlaycount ? &update.playcount : NULL);
+}
+
+void CRecordingUpdateJob::SendDue(bool all, bool retry)
+{
+  // Take the due updates out of the queue, so new changes can be queued while sending
+  std::vector<std::pair<std::string, Update> > updates;
+  {
+    CLockObject lock(m_mutex);
+    int64_t now = GetTimeMs();
+    std::map<std::string, Update>::iterator it = m_updates.begin();
+    while (it != m_updates.end())
+    {
+      if (all || it->second.due <= now)
+      {
+        updates.push_back(*it);
+        m_updates.erase(it++);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+  }
+
+  for (std::vector<std::pair<std::string, Update> >::iterator it = updates.begin(); it != updates.end(); ++it)
+  {
+    if (Send(it->first, it->second) || !retry)
+    {
+      Done(it->first, it->second);
+      continue;
+    }
+
+    Update& failed = it->second;
+    if (++failed.attempts > RECORDING_UPDATE_MAX_RETRIES)
+    {
+      XBMC->Log(LOG_ERROR, "Giving up updating the watched state of recording %s.", it->first.c_str());
+      Done(it->first, failed);
+      continue;
+    }
+
+    CLockObject lock(m_mutex);
+    std::map<std::string, Update>::iterator pending = m_updates.find(it->first);
+    if (pending == m_updates.end())
+    {
+      failed.due = GetTimeMs() + ((int64_t) RECORDING_UPDATE_RETRY_DELAY << (failed.attempts - 1));
+      m_updates[it->first] = failed;
+    }
+    else
+    {
+      // A newer value was queued meanwhile; only keep what it does not replace
+      if (!pending->second.hasPosition && failed.hasPosition)
+      {
+        pending->second.hasPosition = true;
+        pending->second.position = failed.position;
+      }
+      if (!pending->second.hasPlaycount && failed.hasPlaycount)
+      {
+        pending->second.hasPlaycount = true;
+        pending->second.playcount = failed.playcount;
+      }
+    }
+  }
+}
+
+int64_t CRecordingUpdateJob::NextDue(void) const
+{
+  // Call with updates queued
+  std::map<std::string, Update>::const_iterator it = m_updates.begin();
+  int64_t due = it->second.due;
+  for (++it; it != m_updates.end(); ++it)
+    due = std::min(due, it->second.due);
+  return due;
+}
+
+int CRecordingUpdateJob::Run()
+{
+  SendDue(false, true);
+
+  // Nothing queued: the next change schedules the job again
+  CLockObject lock(m_mutex);
+  if (m_updates.empty())
+  {
+    m_scheduledAt = 0;
+    return -1;
+  }
+  m_scheduledAt = NextDue();
+  return (int) std::max((int64_t) 0, m_scheduledAt - GetTimeMs());
+}
@@ -0,0 +1,85 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <map>
+#include <string>
+#include "p8-platform/threads/mutex.h"
+#include "Scheduler.h"
+
+class cRecordingCache;
+
+/**
+ * \brief Write-behind queue for resume positions and play counts of recordings.
+ *        Updates are coalesced per recording, only the latest value is sent to the
+ *        server, a short while after the last change or when a flush is requested.
+ *        Failed updates are retried with an increasing delay. The recordings cache
+ *        keeps the queued values over what the server reports until they are sent.
+ *        The job is scheduled for the earliest due update and is not scheduled while
+ *        nothing is queued.
+ */
+class CRecordingUpdateJob : public CScheduledJob
+{
+public:
+  CRecordingUpdateJob(CScheduler& scheduler, cRecordingCache& cache);
+  virtual ~CRecordingUpdateJob(void);
+
+  void SetLastWatchedPosition(const std::string& filename, int position);
+  void SetFullyWatchedCount(const std::string& filename, int playcount);
+
+  /**
+   * \brief Send all pending updates as soon as possible
+   */
+  void FlushAsync(void);
+
+  /**
+   * \brief Send all pending updates from the calling thread, without retries. Used at shutdown,
+   *        after the job was cancelled.
+   */
+  void Flush(void);
+
+  virtual int Run(void);
+
+private:
+  struct Update
+  {
+    bool hasPosition;
+    int position;
+    bool hasPlaycount;
+    int playcount;
+    int attempts;
+    int64_t due;  // GetTimeMs() after which the update is sent
+
+    Update(void) : hasPosition(false), position(0), hasPlaycount(false), playcount(0), attempts(0), due(0) {}
+  };
+
+  void Queue(const std::string& filename, const Update& update);
+  bool Send(const std::string& filename, const Update& update);
+  void SendDue(bool all, bool retry);
+  void Done(const std::string& filename, const Update& update);
+  int64_t NextDue(void) const;
+
+  CScheduler& m_scheduler;
+  cRecordingCache& m_cache;
+  P8PLATFORM::CMutex m_mutex;
+  std::map<std::string, Update> m_updates; // keyed by recording file name
+  int64_t m_scheduledAt; // GetTimeMs() the job was scheduled for, 0 when it is not scheduled
+};
@@ -0,0 +1,258 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <algorithm>
+#include "client.h" //for XBMC->Log
+#include "Scheduler.h"
+#include "p8-platform/util/timeutils.h"
+
+using namespace ADDON;
+using namespace P8PLATFORM;
+
+// Resolution of the wheel in milliseconds
+#define SCHEDULER_TICK 100
+// Number of slots; jobs further ahead than one turn (25.6 s) wait for more turns
+#define SCHEDULER_SLOTS 256
+
+CScheduledJob::CScheduledJob(const char* name, bool bBlocking) :
+  m_name(name),
+  m_bBlocking(bBlocking),
+  m_bScheduled(false),
+  m_bIdle(true),
+  m_bCancelled(false),
+  m_slot(0),
+  m_rounds(0)
+{
+}
+
+CScheduler::CScheduler(void) :
+  m_worker(*this),
+  m_wheel(SCHEDULER_SLOTS),
+  m_current(0),
+  m_tickTime(GetTimeMs())
+{
+  XBMC->Log(LOG_DEBUG, "CScheduler:: constructor");
+}
+
+CScheduler::~CScheduler(void)
+{
+  XBMC->Log(LOG_DEBUG, "CScheduler:: destructor");
+  StopThread();
+}
+
+void CScheduler::Schedule(CScheduledJob* job, unsigned int delayMs)
+{
+  {
+    CLockObject lock(m_mutex);
+    if (job->m_bScheduled)
+      Remove(job);
+    RemoveDue(m_due, job);
+    RemoveDue(m_blocking, job);
+    job->m_bCancelled = false;
+    Insert(job, GetTimeMs(), delayMs);
+  }
+  if (!IsRunning())
+  {
+    if (!CreateThread(false))
+      XBMC->Log(LOG_ERROR, "CScheduler:: could not start the scheduler thread.");
+  }
+  if (job->m_bBlocking && !m_worker.IsRunning())
+  {
+    if (!m_worker.CreateThread(false))
+      XBMC->Log(LOG_ERROR, "CScheduler:: could not start the worker thread.");
+  }
+  m_wakeup.Signal();
+}
+
+void CScheduler::Cancel(CScheduledJob* job)
+{
+  CLockObject lock(m_mutex);
+  if (job->m_bScheduled)
+    Remove(job);
+  RemoveDue(m_due, job);
+  RemoveDue(m_blocking, job);
+  if (!job->m_bIdle)
+  {
+    job->m_bCancelled = true;
+    m_jobDone.Wait(m_mutex, job->m_bIdle);
+  }
+}
+
+bool CScheduler::IsScheduled(CScheduledJob* job)
+{
+  CLockObject lock(m_mutex);
+  return job->m_bScheduled || std::find(m_due.begin(), m_due.end(), job) != m_due.end() ||
+    std::find(m_blocking.begin(), m_blocking.end(), job) != m_blocking.end() ||
+    (!job->m_bIdle && !job->m_bCancelled);
+}
+
+bool CScheduler::StopThread(int iWaitMs)
+{
+  // Flag the threads first, then wake them up from their waits
+  CThread::StopThread(-1);
+  m_worker.StopThread(-1);
+  m_wakeup.Signal();
+  m_workerWakeup.Signal();
+  bool bStopped = CThread::StopThread(iWaitMs);
+  return m_worker.StopThread(iWaitMs) && bStopped;
+}
+
+void CScheduler::Insert(CScheduledJob* job, int64_t now, unsigned int delayMs)
+{
+  int64_t ticks = std::max((int64_t) 0, (now + delayMs - m_tickTime + SCHEDULER_TICK - 1) / SCHEDULER_TICK);
+  job->m_slot = (m_current + ticks) % SCHEDULER_SLOTS;
+  job->m_rounds = (unsigned int) (ticks / SCHEDULER_SLOTS);
+  job->m_bScheduled = true;
+  m_wheel[job->m_slot].push_back(job);
+}
+
+void CScheduler::Remove(CScheduledJob* job)
+{
+  std::vector<CScheduledJob*>& slot = m_wheel[job->m_slot];
+  slot.erase(std::remove(slot.begin(), slot.end(), job), slot.end());
+  job->m_bScheduled = false;
+}
+
+bool CScheduler::RemoveDue(std::vector<CScheduledJob*>& due, CScheduledJob* job)
+{
+  std::vector<CScheduledJob*>::iterator it = std::find(due.begin(), due.end(), job);
+  if (it == due.end())
+    return false;
+  due.erase(it);
+  return true;
+}
+
+int64_t CScheduler::NextDue(void) const
+{
+  // Time of the first tick that has a job in its slot; jobs that are a turn or more away
+  // wake the thread once per turn
+  for (size_t i = 0; i < SCHEDULER_SLOTS; i++)
+  {
+    if (!m_wheel[(m_current + i) % SCHEDULER_SLOTS].empty())
+      return m_tickTime + (int64_t) i * SCHEDULER_TICK;
+  }
+  return m_tickTime + (int64_t) SCHEDULER_SLOTS * SCHEDULER_TICK;
+}
+
+CScheduledJob* CScheduler::TakeDue(std::vector<CScheduledJob*>& due)
+{
+  if (due.empty())
+    return NULL;
+  CScheduledJob* job = due.front();
+  due.erase(due.begin());
+  job->m_bIdle = false;
+  job->m_bCancelled = false;
+  return job;
+}
+
+void CScheduler::RunJob(CScheduledJob* job)
+{
+  int next = job->Run();
+
+  CLockObject lock(m_mutex);
+  if (next >= 0 && !job->m_bCancelled && !job->m_bScheduled)
+    Insert(job, GetTimeMs(), (unsigned int) next);
+  job->m_bIdle = true;
+  m_jobDone.Broadcast();
+  // The scheduler thread may be waiting for a later tick
+  if (job->m_bBlocking)
+    m_wakeup.Signal();
+}
+
+void *CScheduler::Process(void)
+{
+  XBMC->Log(LOG_DEBUG, "CScheduler:: thread started");
+  while (!IsStopped())
+  {
+    CScheduledJob* job = NULL;
+    {
+      CLockObject lock(m_mutex);
+      // Collect the jobs of all ticks that passed, also when the thread was late
+      bool bBlockingDue = false;
+      int64_t now = GetTimeMs();
+      while (m_tickTime <= now)
+      {
+        std::vector<CScheduledJob*>& slot = m_wheel[m_current];
+        for (size_t i = 0; i < slot.size(); )
+        {
+          if (slot[i]->m_rounds > 0)
+          {
+            slot[i]->m_rounds--;
+            i++;
+            continue;
+          }
+          slot[i]->m_bScheduled = false;
+          if (slot[i]->m_bBlocking)
+          {
+            m_blocking.push_back(slot[i]);
+            bBlockingDue = true;
+          }
+          else
+          {
+            m_due.push_back(slot[i]);
+          }
+          slot.erase(slot.begin() + i);
+        }
+        m_current = (m_current + 1) % SCHEDULER_SLOTS;
+        m_tickTime += SCHEDULER_TICK;
+      }
+      if (bBlockingDue)
+        m_workerWakeup.Signal();
+
+      job = TakeDue(m_due);
+    }
+
+    if (job)
+    {
+      RunJob(job);
+      continue;
+    }
+
+    int64_t wait;
+    {
+      CLockObject lock(m_mutex);
+      wait = NextDue() - GetTimeMs();
+    }
+    if (wait > 0)
+      m_wakeup.Wait((uint32_t) wait);
+  }
+  XBMC->Log(LOG_DEBUG, "CScheduler:: thread stopped");
+  return NULL;
+}
+
+void *CScheduler::CWorker::Process(void)
+{
+  XBMC->Log(LOG_DEBUG, "CScheduler:: worker thread started");
+  while (!IsStopped())
+  {
+    CScheduledJob* job;
+    {
+      CLockObject lock(m_scheduler.m_mutex);
+      job = m_scheduler.TakeDue(m_scheduler.m_blocking);
+    }
+    if (job)
+      m_scheduler.RunJob(job);
+    else
+      m_scheduler.m_workerWakeup.Wait();
+  }
+  XBMC->Log(LOG_DEBUG, "CScheduler:: worker thread stopped");
+  return NULL;
+}
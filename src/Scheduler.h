@@ -0,0 +1,119 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <stdint.h>
+#include <vector>
+#include "p8-platform/threads/threads.h"
+
+class CScheduler;
+
+/**
+ * \brief Periodic work that is executed on the thread of a CScheduler
+ */
+class CScheduledJob
+{
+public:
+  /**
+   * \param bBlocking the job waits for the server for longer than a moment (guide fetches, event
+   *        handling) and runs on the worker thread of the scheduler
+   */
+  CScheduledJob(const char* name, bool bBlocking = false);
+  virtual ~CScheduledJob(void) {}
+
+  /**
+   * \brief Do the work
+   * \return milliseconds until the next run, a negative value when the job is done
+   */
+  virtual int Run(void) = 0;
+
+  const char* Name(void) const { return m_name; }
+
+private:
+  friend class CScheduler;
+  const char*  m_name;
+  bool         m_bBlocking;  // runs on the worker thread
+  bool         m_bScheduled; // in the wheel
+  bool         m_bIdle;      // not running
+  bool         m_bCancelled; // cancelled while running, do not schedule it again
+  size_t       m_slot;       // slot in the wheel
+  unsigned int m_rounds;     // turns of the wheel to wait before the job is due
+};
+
+/**
+ * \brief Runs the periodic jobs of the add-on. The jobs are kept in a timer wheel with 100 ms ticks;
+ *        the thread sleeps until the next tick that has a job, or until a job is scheduled or the
+ *        thread is stopped. Short jobs run on that thread one at a time, so they must not block long.
+ *        Blocking jobs are handed to a worker thread that runs them one at a time, so a slow server
+ *        call does not delay the short jobs (the live stream keepalive).
+ */
+class CScheduler : public P8PLATFORM::CThread
+{
+public:
+  CScheduler(void);
+  virtual ~CScheduler(void);
+
+  /**
+   * \brief Run a job after delayMs milliseconds. A job that is already scheduled is moved.
+   *        The thread is started when needed.
+   */
+  void Schedule(CScheduledJob* job, unsigned int delayMs);
+
+  /**
+   * \brief Remove a job from the schedule. When the job is running, wait until it finished, so
+   *        the job can be deleted afterwards. Must not be called from a job.
+   */
+  void Cancel(CScheduledJob* job);
+
+  bool IsScheduled(CScheduledJob* job);
+
+  virtual bool StopThread(int iWaitMs = 5000);
+
+private:
+  class CWorker : public P8PLATFORM::CThread
+  {
+  public:
+    CWorker(CScheduler& scheduler) : m_scheduler(scheduler) {}
+  private:
+    virtual void *Process(void);
+    CScheduler& m_scheduler;
+  };
+
+  virtual void *Process(void);
+
+  void Insert(CScheduledJob* job, int64_t now, unsigned int delayMs);
+  void Remove(CScheduledJob* job);
+  static bool RemoveDue(std::vector<CScheduledJob*>& due, CScheduledJob* job);
+  int64_t NextDue(void) const;
+  CScheduledJob* TakeDue(std::vector<CScheduledJob*>& due);
+  void RunJob(CScheduledJob* job);
+
+  P8PLATFORM::CMutex m_mutex;
+  P8PLATFORM::CCondition<bool> m_jobDone;
+  P8PLATFORM::CEvent m_wakeup;
+  P8PLATFORM::CEvent m_workerWakeup;
+  CWorker m_worker;
+  std::vector<std::vector<CScheduledJob*> > m_wheel;
+  std::vector<CScheduledJob*> m_due;      // taken from the wheel, waiting for their turn to run
+  std::vector<CScheduledJob*> m_blocking; // the same for the worker thread
+  size_t         m_current;  // slot of the tick at m_tickTime
+  int64_t        m_tickTime; // time of the next tick to process
+};
@@ -0,0 +1,117 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <string.h>
+#include <string>
+#include "client.h" //for XBMC->Log
+#include "argustvrpc.h"
+#include "SignalQualityJob.h"
+#include "p8-platform/util/timeutils.h"
+
+using namespace ADDON;
+using namespace P8PLATFORM;
+
+// Milliseconds between two samples while the status is shown
+#define SIGNALQUALITY_INTERVAL 2000
+// Sampling stops when Kodi did not ask for the status for this many milliseconds
+#define SIGNALQUALITY_IDLE 5000
+
+static std::shared_ptr<const PVR_SIGNAL_STATUS> EmptyStatus(void)
+{
+  std::shared_ptr<PVR_SIGNAL_STATUS> status(new PVR_SIGNAL_STATUS);
+  memset(status.get(), 0, sizeof(PVR_SIGNAL_STATUS));
+  return status;
+}
+
+CSignalQualityJob::CSignalQualityJob(void) :
+  CScheduledJob("signal quality", true),
+  m_status(EmptyStatus()),
+  m_lastRequest(0)
+{
+  XBMC->Log(LOG_DEBUG, "CSignalQualityJob:: constructor");
+}
+
+CSignalQualityJob::~CSignalQualityJob(void)
+{
+  XBMC->Log(LOG_DEBUG, "CSignalQualityJob:: destructor");
+}
+
+void CSignalQualityJob::GetStatus(PVR_SIGNAL_STATUS& status)
+{
+  m_lastRequest = GetTimeMs();
+  status = *std::atomic_load(&m_status);
+}
+
+void CSignalQualityJob::Reset(void)
+{
+  std::atomic_store(&m_status, EmptyStatus());
+}
+
+int CSignalQualityJob::Run(void)
+{
+  // The info is no longer shown
+  if (GetTimeMs() - m_lastRequest >= SIGNALQUALITY_IDLE)
+    return -1;
+
+  Json::Value response;
+  if (ArgusTV::SignalQuality(response) < 0)
+    return SIGNALQUALITY_INTERVAL;
+
+  std::shared_ptr<PVR_SIGNAL_STATUS> sample(new PVR_SIGNAL_STATUS);
+  PVR_SIGNAL_STATUS& tag = *sample;
+  memset(&tag, 0, sizeof(tag));
+  std::string cardtype = "";
+  switch (response["CardType"].asInt())
+  {
+  case 0x80:
+    cardtype = "Analog";
+    break;
+  case 8:
+    cardtype = "ATSC";
+    break;
+  case 4:
+    cardtype = "DVB-C";
+    break;
+  case 0x10:
+    cardtype = "DVB-IP";
+    break;
+  case 1:
+    cardtype = "DVB-S";
+    break;
+  case 2:
+    cardtype = "DVB-T";
+    break;
+  default:
+    cardtype = "Unknown card type";
+    break;
+  }
+  snprintf(tag.strAdapterName, 1024, "Provider %s, %s",
+    response["ProviderName"].asString().c_str(),
+    cardtype.c_str());
+  snprintf(tag.strAdapterStatus, 1024, "%s, %s",
+    response["Name"].asString().c_str(),
+    response["IsFreeToAir"].asBool() ? "free to air" : "encrypted");
+  tag.iSNR = (int) (response["SignalQuality"].asInt() * 655.35);
+  tag.iSignal = (int) (response["SignalStrength"].asInt() * 655.35);
+
+  std::atomic_store(&m_status, std::shared_ptr<const PVR_SIGNAL_STATUS>(sample));
+  return SIGNALQUALITY_INTERVAL;
+}
@@ -0,0 +1,57 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include "xbmc_pvr_types.h"
+#include "Scheduler.h"
+
+/**
+ * \brief Samples the tuning details of the live stream in the background, so SignalStatus()
+ *        never waits for the server. Kodi only asks for the signal status while the codec or
+ *        signal info is shown; the job samples every SIGNALQUALITY_INTERVAL while it is asked
+ *        and ends when it has not been asked for SIGNALQUALITY_IDLE.
+ */
+class CSignalQualityJob : public CScheduledJob
+{
+public:
+  CSignalQualityJob(void);
+  virtual ~CSignalQualityJob(void);
+
+  /**
+   * \brief Copy the latest sample and note that the status is shown
+   */
+  void GetStatus(PVR_SIGNAL_STATUS& status);
+
+  /**
+   * \brief Forget the sample of the previous stream
+   */
+  void Reset(void);
+
+  virtual int Run(void);
+
+private:
+  // Replaced as a whole by Run(), read with atomic_load, so readers never see half a sample
+  std::shared_ptr<const PVR_SIGNAL_STATUS> m_status;
+  std::atomic<int64_t> m_lastRequest; // time of the last GetStatus()
+};
@@ -38,12 +38,41 @@ using namespace ADDON;
 // Some version dependent API strings
 #define ATV_GETEPG_45 "ArgusTV/Guide/FullPrograms/%s/%i-%02i-%02iT%02i:%02i:%02i/%i-%02i-%02iT%02i:%02i:%02i/false"
 
+// Maximum number of requests that are sent to the ARGUS TV server at the same time
+#define ATV_MAX_CONCURRENT_REQUESTS 4
+
 /**
  * \brief Namespace with ArgusTV related code
  */
 namespace ArgusTV
 {
   P8PLATFORM::CMutex communication_mutex;
+  P8PLATFORM::CCondition<bool> communication_condition;
+  int communication_slots = ATV_MAX_CONCURRENT_REQUESTS;
+  bool communication_slotfree = true;
+
+  /**
+   * \brief Claims one of the request slots for the lifetime of the object
+   */
+  class CRequestSlot
+  {
+  public:
+    CRequestSlot(void)
+    {
+      P8PLATFORM::CLockObject lock(communication_mutex);
+      communication_condition.Wait(communication_mutex, communication_slotfree);
+      if (--communication_slots == 0)
+        communication_slotfree = false;
+    }
+
+    ~CRequestSlot(void)
+    {
+      P8PLATFORM::CLockObject lock(communication_mutex);
+      communication_slots++;
+      communication_slotfree = true;
+      communication_condition.Signal();
+    }
+  };
 
   /**
    * \brief Do some internal housekeeping at the start
@@ -52,6 +81,7 @@ namespace ArgusTV
   {
     //// due to lack of static constructors...
     //curl_global_init(CURL_GLOBAL_ALL);
+    ClearEmptySchedule();
   }
 
 
@@ -65,7 +95,7 @@ namespace ArgusTV
 
   int ArgusTVRPC(const std::string& command, const std::string& arguments, std::string& json_response)
   {
-    P8PLATFORM::CLockObject critsec(communication_mutex);
+    CRequestSlot slot;
     std::string url = g_szBaseURL + command;
     int retval = E_FAILED;
     XBMC->Log(LOG_DEBUG, "URL: %s\n", url.c_str());
@@ -101,7 +131,7 @@ namespace ArgusTV
 
   int ArgusTVRPCToFile(const std::string& command, const std::string& arguments, std::string& filename, long& http_response)
   {
-    P8PLATFORM::CLockObject critsec(communication_mutex);
+    CRequestSlot slot;
     std::string url = g_szBaseURL + command;
     int retval = E_FAILED;
     XBMC->Log(LOG_DEBUG, "URL: %s writing to file %s\n", url.c_str(), filename.c_str());
@@ -518,7 +548,16 @@ namespace ArgusTV
   }
 
   //Remember the last LiveStream object to be able to stop the stream again
+  //Kodi tunes and stops on its own thread while the scheduler keeps the stream alive, so the
+  //object is only touched under livestream_mutex and the requests are built from a copy
   Json::Value g_current_livestream;
+  P8PLATFORM::CMutex livestream_mutex;
+
+  static Json::Value CurrentLiveStream(void)
+  {
+    P8PLATFORM::CLockObject lock(livestream_mutex);
+    return g_current_livestream;
+  }
 
   int TuneLiveStream(const std::string& channel_id, ChannelType channeltype, const std::string channelname, std::string& stream)
   {
@@ -532,10 +571,11 @@ namespace ArgusTV
     snprintf(command, 512, "{\"Channel\":{\"BroadcastStart\":\"\",\"BroadcastStop\":\"\",\"ChannelId\":\"%s\",\"ChannelType\":%i,\"DefaultPostRecordSeconds\":0,\"DefaultPreRecordSeconds\":0,\"DisplayName\":\"%s\",\"GuideChannelId\":\"00000000-0000-0000-0000-000000000000\",\"LogicalChannelNumber\":null,\"Sequence\":0,\"Version\":0,\"VisibleInGuide\":true},\"LiveStream\":",
       channel_id.c_str(), channeltype, channelname.c_str());
     std::string arguments = command;
-    if (!g_current_livestream.empty())
+    Json::Value current = CurrentLiveStream();
+    if (!current.empty())
     {
       Json::FastWriter writer;
-      arguments.append(writer.write(g_current_livestream)).append("}");
+      arguments.append(writer.write(current)).append("}");
     }
     else
     {
@@ -563,6 +603,7 @@ namespace ArgusTV
         Json::Value livestream = response["LiveStream"];
         if (livestream != Json::nullValue)
         {
+          P8PLATFORM::CLockObject lock(livestream_mutex);
           g_current_livestream = livestream;
         }
         else
@@ -570,8 +611,8 @@ namespace ArgusTV
           XBMC->Log(LOG_DEBUG, "No LiveStream received from server.");
           return E_FAILED;
         }
-        stream = g_current_livestream["TimeshiftFile"].asString();
-        //stream = g_current_livestream["RtspUrl"].asString();
+        stream = livestream["TimeshiftFile"].asString();
+        //stream = livestream["RtspUrl"].asString();
         XBMC->Log(LOG_DEBUG, "Tuned live stream: %s\n", stream.c_str());
         return E_SUCCESS;
       }
@@ -591,14 +632,16 @@ namespace ArgusTV
 
   int StopLiveStream()
   {
-    if(!g_current_livestream.empty())
+    Json::Value current = CurrentLiveStream();
+    if(!current.empty())
     {
       Json::FastWriter writer;
-      std::string arguments = writer.write(g_current_livestream);
+      std::string arguments = writer.write(current);
 
       std::string response;
       int retval = ArgusTVRPC("ArgusTV/Control/StopLiveStream", arguments, response);
 
+      P8PLATFORM::CLockObject lock(livestream_mutex);
       g_current_livestream.clear();
 
       return retval;
@@ -613,19 +656,21 @@ namespace ArgusTV
   {
     std::string stream = "";
 
-    if(!g_current_livestream.empty())
+    Json::Value current = CurrentLiveStream();
+    if(!current.empty())
     {
-      stream = g_current_livestream["RtspUrl"].asString();
+      stream = current["RtspUrl"].asString();
     }
     return stream;
   }
 
   int SignalQuality(Json::Value& response)
   {
-    if(!g_current_livestream.empty())
+    Json::Value current = CurrentLiveStream();
+    if(!current.empty())
     {
       Json::FastWriter writer;
-      std::string arguments = writer.write(g_current_livestream);
+      std::string arguments = writer.write(current);
 
       int retval = ArgusTVJSONRPC("ArgusTV/Control/GetLiveStreamTuningDetails", arguments, response);
 
@@ -648,10 +693,11 @@ namespace ArgusTV
     //{"CardId":"String content","Channel":{"BroadcastStart":"String content","BroadcastStop":"String content","ChannelId":"1627aea5-8e0a-4371-9022-9b504344e724","ChannelType":0,"DefaultPostRecordSeconds":2147483647,"DefaultPreRecordSeconds":2147483647,"DisplayName":"String content","GuideChannelId":"1627aea5-8e0a-4371-9022-9b504344e724","LogicalChannelNumber":2147483647,"Sequence":2147483647,"Version":2147483647,"VisibleInGuide":true},"RecorderTunerId":"1627aea5-8e0a-4371-9022-9b504344e724","RtspUrl":"String content","StreamLastAliveTime":"\/Date(928142400000+0200)\/","StreamStartedTime":"\/Date(928142400000+0200)\/","TimeshiftFile":"String content"}
     //Example response:
     //true
-    if(!g_current_livestream.empty())
+    Json::Value current = CurrentLiveStream();
+    if(!current.empty())
     {
       Json::FastWriter writer;
-      std::string arguments = writer.write(g_current_livestream);
+      std::string arguments = writer.write(current);
 
       Json::Value response;
       int retval = ArgusTVJSONRPC("ArgusTV/Control/KeepLiveStreamAlive", arguments, response);
@@ -668,6 +714,15 @@ namespace ArgusTV
     return false;
   }
 
+  time_t GetLiveStreamLastAliveTime(void)
+  {
+    Json::Value current = CurrentLiveStream();
+    if (current.empty())
+      return 0;
+    int offset;
+    return WCFDateToTimeT(current["StreamLastAliveTime"].asString(), offset);
+  }
+
   int GetEPGData(const std::string& guidechannel_id, struct tm epg_start, struct tm epg_end, Json::Value& response)
   {
     if ( guidechannel_id.length() > 0 )
@@ -732,6 +787,35 @@ namespace ArgusTV
     return retval;
   }
 
+  int GetFullRecordings(Json::Value& response)
+  {
+    XBMC->Log(LOG_DEBUG, "GetFullRecordings");
+    std::string command = "ArgusTV/Control/GetFullRecordings/Television?includeNonExisting=false";
+    Json::Value jsArgument;
+    jsArgument["ScheduleId"] = Json::nullValue;
+    jsArgument["ProgramTitle"] = Json::nullValue;
+    jsArgument["Category"] = Json::nullValue;
+    jsArgument["ChannelId"] = Json::nullValue;
+    Json::FastWriter writer;
+    std::string arguments = writer.write(jsArgument);
+
+    int retval = ArgusTV::ArgusTVJSONRPC(command, arguments, response);
+    if (retval >= 0)
+    {
+      if (response.type() != Json::arrayValue)
+      {
+        retval = E_FAILED;
+        XBMC->Log(LOG_NOTICE, "GetFullRecordings did not return a Json::arrayValue [%d].", response.type());
+      }
+    }
+    else
+    {
+      XBMC->Log(LOG_NOTICE, "GetFullRecordings remote call failed. (%d)", retval);
+    }
+
+    return retval;
+  }
+
   int GetRecordingById(const std::string& id, Json::Value& response)
   {
     XBMC->Log(LOG_DEBUG, "GetRecordingById");
@@ -959,6 +1043,8 @@ namespace ArgusTV
     XBMC->Log(LOG_DEBUG, "GetUpcomingRecordings");
 
     // http://madcat:49943/ArgusTV/Control/UpcomingRecordings/7?includeCancelled=true
+    // 7 is the UpcomingRecordingsFilter (Recordings | CancelledByUser | CancelledBySystem), not a number
+    // of days; the server has no time window or paging for this list
     retval = ArgusTVJSONRPC("ArgusTV/Control/UpcomingRecordings/7?includeActive=true", "", response);
 
     if(retval >= 0)
@@ -1067,6 +1153,17 @@ namespace ArgusTV
     return retval;
   }
 
+  //Remember the empty schedule template. Its defaults come from the server's configuration, so it is
+  //cleared on every connect and when the server reports a configuration change.
+  P8PLATFORM::CMutex g_empty_schedule_mutex;
+  Json::Value g_empty_schedule;
+
+  void ClearEmptySchedule(void)
+  {
+    P8PLATFORM::CLockObject lock(g_empty_schedule_mutex);
+    g_empty_schedule = Json::Value();
+  }
+
     /**
    * \brief Retrieve an empty schedule from the server
    */
@@ -1075,6 +1172,15 @@ namespace ArgusTV
     int retval = -1;
     XBMC->Log(LOG_DEBUG, "GetEmptySchedule");
 
+    {
+      P8PLATFORM::CLockObject lock(g_empty_schedule_mutex);
+      if (g_empty_schedule.isObject())
+      {
+        response = g_empty_schedule;
+        return 0;
+      }
+    }
+
     retval = ArgusTVJSONRPC("ArgusTV/Scheduler/EmptySchedule/0/82", "", response);
 
     if(retval >= 0)
@@ -1084,6 +1190,8 @@ namespace ArgusTV
         XBMC->Log(LOG_DEBUG, "Unknown response format. Expected Json::objectValue\n");
         return -1;
       }
+      P8PLATFORM::CLockObject lock(g_empty_schedule_mutex);
+      g_empty_schedule = response;
     }
     else
     {
@@ -182,6 +182,11 @@ namespace ArgusTV
    */
   bool KeepLiveStreamAlive();
 
+  /**
+   * \brief StreamLastAliveTime of the current live stream as the server reported it when tuning, 0 when there is none
+   */
+  time_t GetLiveStreamLastAliveTime(void);
+
   /**
    * \brief Fetch the list of availalable channels for tv or radio
    * \param channeltype  The type of channel to fetch the list for
@@ -209,6 +214,12 @@ namespace ArgusTV
    */
   int GetFullRecordingsForTitle(const std::string& title, Json::Value& response);
 
+  /**
+   * \brief Fetch the detailed data for all television recordings in one request
+   * \param response Reference to a std::string used to store the json response string
+   */
+  int GetFullRecordings(Json::Value& response);
+
   /**
    * \brief Fetch the detailed information of a recorded show
    * \param id unique id (guid) of the recording
@@ -297,10 +308,16 @@ namespace ArgusTV
   int CancelUpcomingProgram(const std::string& scheduleid, const std::string& channelid, const time_t starttime, const std::string& upcomingprogramid);
 
   /**
-   * \brief Retrieve an empty schedule from the server
+   * \brief Retrieve an empty schedule from the server. The template is requested once per connection
+   *        and again after the server reported a configuration change.
    */
   int GetEmptySchedule(Json::Value& response);
 
+  /**
+   * \brief Forget the empty schedule template, the next GetEmptySchedule requests it again
+   */
+  void ClearEmptySchedule(void);
+
   /**
    * \brief Add a xbmc timer as a one time schedule
    */
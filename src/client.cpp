@@ -38,7 +38,10 @@ bool        g_bUseFolder           = DEFAULT_USEFOLDER;    ///< Use folders for
 std::string g_szUser               = DEFAULT_USER;         ///< Windows user account used to access share
 std::string g_szPass               = DEFAULT_PASS;         ///< Windows user password used to access share
                                                            ///< Leave empty to use current user when running on Windows
-int         g_iTuneDelay           = DEFAULT_TUNEDELAY;    ///< Number of milliseconds to delay after tuning a channel
+int         g_iTuneDelay           = DEFAULT_TUNEDELAY;    ///< Maximum number of milliseconds to wait for a decodable stream after tuning a channel
+int         g_iEpgCacheSize        = DEFAULT_EPGCACHESIZE; ///< Maximum size of the guide data cache in MB, 0 disables the cache
+int         g_iUpcomingDays        = DEFAULT_UPCOMINGDAYS; ///< Number of days ahead for which timers are shown, 0 shows all
+bool        g_bPrefetch            = DEFAULT_PREFETCH;     ///< Read streams ahead on a separate thread
 
 std::string  g_szBaseURL;
 
@@ -151,7 +154,7 @@ ADDON_STATUS ADDON_Create(void* hdl, void* props)
   if (!XBMC->GetSetting("tunedelay", &g_iTuneDelay))
   {
     /* If setting is unknown fallback to defaults */
-    XBMC->Log(LOG_ERROR, "Couldn't get 'tunedelay' setting, falling back to '200' as default");
+    XBMC->Log(LOG_ERROR, "Couldn't get 'tunedelay' setting, falling back to '2000' as default");
     g_iTuneDelay = DEFAULT_TUNEDELAY;
   }
 
@@ -163,6 +166,37 @@ ADDON_STATUS ADDON_Create(void* hdl, void* props)
 	g_bUseFolder = DEFAULT_USEFOLDER;
   }
 
+  /* Read setting "epgcachesize" from settings.xml */
+  if (!XBMC->GetSetting("epgcachesize", &g_iEpgCacheSize))
+  {
+    /* If setting is unknown fallback to defaults */
+    XBMC->Log(LOG_ERROR, "Couldn't get 'epgcachesize' setting, falling back to '32' as default");
+    g_iEpgCacheSize = DEFAULT_EPGCACHESIZE;
+  }
+
+  /* Read setting "upcomingdays" from settings.xml */
+  if (!XBMC->GetSetting("upcomingdays", &g_iUpcomingDays))
+  {
+    /* If setting is unknown fallback to defaults */
+    XBMC->Log(LOG_ERROR, "Couldn't get 'upcomingdays' setting, falling back to '0' as default");
+    g_iUpcomingDays = DEFAULT_UPCOMINGDAYS;
+  }
+
+  /* Read setting "prefetch" from settings.xml */
+  if (!XBMC->GetSetting("prefetch", &g_bPrefetch))
+  {
+    /* If setting is unknown fallback to defaults */
+    XBMC->Log(LOG_ERROR, "Couldn't get 'prefetch' setting, falling back to 'true' as default");
+    g_bPrefetch = DEFAULT_PREFETCH;
+  }
+
+  /* read setting "localpaths" from settings.xml */
+  buffer[0] = 0;
+  if (XBMC->GetSetting("localpaths", buffer))
+    SetLocalPaths(buffer);
+  else
+    SetLocalPaths(DEFAULT_LOCALPATHS);
+
   /* Connect to ARGUS TV */
   if (!g_client->Connect())
   {
@@ -271,6 +305,31 @@ ADDON_STATUS ADDON_SetSetting(const char *settingName, const void *settingValue)
     XBMC->Log(LOG_INFO, "Changed setting 'usefolder' from %u to %u", g_bUseFolder, *(bool*)settingValue);
     g_bUseFolder = *(bool*)settingValue;
   }
+  else if (str == "epgcachesize")
+  {
+    XBMC->Log(LOG_INFO, "Changed setting 'epgcachesize' from %u to %u", g_iEpgCacheSize, *(int*) settingValue);
+    g_iEpgCacheSize = *(int*) settingValue;
+  }
+  else if (str == "upcomingdays")
+  {
+    XBMC->Log(LOG_INFO, "Changed setting 'upcomingdays' from %u to %u", g_iUpcomingDays, *(int*) settingValue);
+    g_iUpcomingDays = *(int*) settingValue;
+    if (g_client)
+    {
+      g_client->OnTimersChanged();
+      PVR->TriggerTimerUpdate();
+    }
+  }
+  else if (str == "prefetch")
+  {
+    XBMC->Log(LOG_INFO, "Changed setting 'prefetch' from %u to %u", g_bPrefetch, *(bool*) settingValue);
+    g_bPrefetch = *(bool*) settingValue;
+  }
+  else if (str == "localpaths")
+  {
+    XBMC->Log(LOG_INFO, "Changed Setting 'localpaths' from %s to %s", GetLocalPaths().c_str(), (const char*) settingValue);
+    SetLocalPaths((const char*) settingValue);
+  }
 
   return ADDON_STATUS_OK;
 }
@@ -395,6 +454,14 @@ PVR_ERROR GetEPGForChannel(ADDON_HANDLE handle, const PVR_CHANNEL &channel, time
   return g_client->GetEpg(handle, channel, iStart, iEnd);
 }
 
+PVR_ERROR SetEPGTimeFrame(int iDays)
+{
+  if (!g_client)
+    return PVR_ERROR_SERVER_ERROR;
+
+  return g_client->SetEPGTimeFrame(iDays);
+}
+
 
 /*******************************************/
 /** PVR Channel Functions                 **/
@@ -648,5 +715,4 @@ time_t GetBufferTimeEnd() { return 0; }
 bool IsRealTimeStream() { return true; }
 PVR_ERROR UndeleteRecording(const PVR_RECORDING& recording) { return PVR_ERROR_NOT_IMPLEMENTED; }
 PVR_ERROR DeleteAllRecordingsFromTrash() { return PVR_ERROR_NOT_IMPLEMENTED;}
-PVR_ERROR SetEPGTimeFrame(int) { return PVR_ERROR_NOT_IMPLEMENTED; }
 } //end extern "C"
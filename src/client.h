@@ -33,8 +33,12 @@
 #define DEFAULT_TIMEOUT               10
 #define DEFAULT_USER                  "Guest"
 #define DEFAULT_PASS                  ""
-#define DEFAULT_TUNEDELAY             200
+#define DEFAULT_TUNEDELAY             2000
 #define DEFAULT_USEFOLDER             false
+#define DEFAULT_EPGCACHESIZE          32
+#define DEFAULT_UPCOMINGDAYS          0
+#define DEFAULT_PREFETCH              true
+#define DEFAULT_LOCALPATHS            ""
 
 extern bool         g_bCreated;           ///< Shows that the Create function was successfully called
 extern std::string  g_szUserPath;         ///< The Path to the user directory inside user profile
@@ -49,6 +53,9 @@ extern std::string  g_szUser;
 extern std::string  g_szPass;
 extern int          g_iTuneDelay;
 extern bool         g_bUseFolder;
+extern int          g_iEpgCacheSize;
+extern int          g_iUpcomingDays;
+extern bool         g_bPrefetch;
 
 extern std::string  g_szBaseURL;
 
@@ -35,6 +35,19 @@ cEpg::cEpg() :
 {
 }
 
+cEpg::cEpg(const std::string& guideprogramid, time_t starttime, time_t endtime, const std::string& title,
+  const std::string& subtitle, const std::string& description, const std::string& genre) :
+  m_guideprogramid(guideprogramid),
+  m_title(title),
+  m_subtitle(subtitle),
+  m_description(description),
+  m_genre(genre),
+  m_starttime(starttime),
+  m_endtime(endtime),
+  m_utcdiff(0)
+{
+}
+
 cEpg::~cEpg()
 {
 }
@@ -42,6 +42,8 @@ private:
 
 public:
   cEpg();
+  cEpg(const std::string& guideprogramid, time_t starttime, time_t endtime, const std::string& title,
+    const std::string& subtitle, const std::string& description, const std::string& genre);
   virtual ~cEpg();
   void Reset();
 
@@ -0,0 +1,904 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include "client.h"
+#include "argustvrpc.h"
+#include "epgcache.h"
+#include "JobPool.h"
+#include "tools.h"
+#if !defined(TARGET_WINDOWS)
+#include <sys/mman.h>
+#endif
+
+using namespace ADDON;
+using namespace P8PLATFORM;
+
+#define EPG_CACHE_BLOCK_TTL     (4*60*60) // refetch a day block after 4 hours
+#define EPG_CACHE_FETCH_THREADS 4
+#define EPG_CACHE_PAST_DAYS     1 // days kept before today until Kodi asks for more
+#define EPG_CACHE_MAX_PAST_DAYS 7
+
+// Cache file format: header, string table, channel sections. All fields in native byte order,
+// strings and channel ids are padded to a multiple of 4 bytes.
+#define EPG_CACHE_FILE_MAGIC    "ATVEPG\0\0"
+#define EPG_CACHE_FILE_VERSION  1
+#define EPG_CACHE_BYTE_ORDER    0x01020304
+
+namespace
+{
+  /**
+   * \brief localtime() into a caller's struct tm; the fetch jobs run on several threads at once
+   */
+  void LocalTime(time_t t, struct tm& result)
+  {
+#if defined(TARGET_WINDOWS)
+    localtime_s(&result, &t);
+#else
+    localtime_r(&t, &result);
+#endif
+  }
+
+  /**
+   * \brief Retrieve and parse the guide programs of a guide channel in [start, end)
+   */
+  bool FetchPrograms(const std::string& guidechannelid, time_t start, time_t end, std::vector<cEpg>& programs)
+  {
+    struct tm tm_start;
+    struct tm tm_end;
+    LocalTime(start, tm_start);
+    LocalTime(end, tm_end);
+    Json::Value response;
+
+    programs.clear();
+    if (ArgusTV::GetEPGData(guidechannelid, tm_start, tm_end, response) == E_FAILED)
+    {
+      XBMC->Log(LOG_ERROR, "GetEPGData failed for guide channel %s.", guidechannelid.c_str());
+      return false;
+    }
+
+    if (response.type() == Json::arrayValue)
+    {
+      int size = response.size();
+      programs.reserve(size);
+      for (int index = 0; index < size; ++index)
+      {
+        cEpg epg;
+        if (epg.Parse(response[index]))
+          programs.push_back(epg);
+      }
+    }
+    return true;
+  }
+
+  class CFetchDayJob : public CJob
+  {
+  public:
+    CFetchDayJob(const std::string& guidechannelid, int day, time_t start, time_t end) :
+      m_guidechannelid(guidechannelid), m_day(day), m_start(start), m_end(end), m_bSuccess(false) {}
+
+    virtual void Run(void)
+    {
+      m_bSuccess = FetchPrograms(m_guidechannelid, m_start, m_end, m_programs);
+    }
+
+    int Day(void) const { return m_day; }
+    bool Success(void) const { return m_bSuccess; }
+    std::vector<cEpg>& Programs(void) { return m_programs; }
+
+  private:
+    std::string m_guidechannelid;
+    int m_day;
+    time_t m_start;
+    time_t m_end;
+    bool m_bSuccess;
+    std::vector<cEpg> m_programs;
+  };
+
+  struct FileHeader
+  {
+    char     magic[8];
+    uint32_t version;
+    uint32_t byteorder;
+    uint32_t recordsize;
+    uint32_t stringcount;
+    uint32_t channelcount;
+    uint32_t reserved;
+    int64_t  saved;
+  };
+
+  /**
+   * \brief Read-only memory mapping of a complete file
+   */
+  class CMappedFile
+  {
+  public:
+    CMappedFile(void) : m_data(NULL), m_size(0)
+#if defined(TARGET_WINDOWS)
+      , m_file(INVALID_HANDLE_VALUE), m_mapping(NULL)
+#endif
+    {
+    }
+
+    ~CMappedFile(void)
+    {
+#if defined(TARGET_WINDOWS)
+      if (m_data)
+        UnmapViewOfFile(m_data);
+      if (m_mapping)
+        CloseHandle(m_mapping);
+      if (m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+#else
+      if (m_data)
+        munmap((void*) m_data, m_size);
+#endif
+    }
+
+    bool Open(const std::string& filename)
+    {
+#if defined(TARGET_WINDOWS)
+      m_file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+      if (m_file == INVALID_HANDLE_VALUE)
+        return false;
+      LARGE_INTEGER size;
+      if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+        return false;
+      m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+      if (m_mapping == NULL)
+        return false;
+      m_data = (const uint8_t*) MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+      m_size = (size_t) size.QuadPart;
+#else
+      int fd = open(filename.c_str(), O_RDONLY);
+      if (fd < 0)
+        return false;
+      struct stat st;
+      if (fstat(fd, &st) == 0 && st.st_size > 0)
+      {
+        void* data = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+          m_data = (const uint8_t*) data;
+          m_size = (size_t) st.st_size;
+        }
+      }
+      close(fd);
+#endif
+      return (m_data != NULL);
+    }
+
+    const uint8_t* Data(void) const { return m_data; }
+    size_t Size(void) const { return m_size; }
+
+  private:
+    const uint8_t* m_data;
+    size_t m_size;
+#if defined(TARGET_WINDOWS)
+    HANDLE m_file;
+    HANDLE m_mapping;
+#endif
+  };
+
+  /**
+   * \brief Bounds checked sequential reads from a mapped cache file
+   */
+  class CFileCursor
+  {
+  public:
+    CFileCursor(const uint8_t* data, size_t size) : m_pos(data), m_end(data + size) {}
+
+    bool Read(void* buffer, size_t size)
+    {
+      if ((size_t) (m_end - m_pos) < size)
+        return false;
+      memcpy(buffer, m_pos, size);
+      m_pos += size;
+      return true;
+    }
+
+    bool ReadString(std::string& str)
+    {
+      uint32_t length;
+      if (!Read(&length, sizeof(length)) || (size_t) (m_end - m_pos) < Padded(length))
+        return false;
+      str.assign((const char*) m_pos, length);
+      m_pos += Padded(length);
+      return true;
+    }
+
+    static size_t Padded(size_t length) { return (length + 3) & ~((size_t) 3); }
+
+  private:
+    const uint8_t* m_pos;
+    const uint8_t* m_end;
+  };
+
+  bool WriteString(FILE* file, const std::string& str)
+  {
+    static const char padding[4] = { 0, 0, 0, 0 };
+    uint32_t length = (uint32_t) str.length();
+    size_t pad = CFileCursor::Padded(length) - length;
+    return fwrite(&length, sizeof(length), 1, file) == 1
+      && (length == 0 || fwrite(str.data(), length, 1, file) == 1)
+      && (pad == 0 || fwrite(padding, pad, 1, file) == 1);
+  }
+
+  struct LessStart
+  {
+    bool operator()(const cEpgRecord& record, time_t t) const { return (time_t) record.starttime < t; }
+  };
+}
+
+cEpgCache::cEpgCache(void) :
+  m_records(0),
+  m_sequence(0),
+  m_timeframe(EPG_TIMEFRAME_UNLIMITED),
+  m_pastdays(EPG_CACHE_PAST_DAYS)
+{
+}
+
+cEpgCache::~cEpgCache(void)
+{
+}
+
+int cEpgCache::DayOf(time_t t)
+{
+  return (int) (t / SECSINDAY);
+}
+
+time_t cEpgCache::StartOfDay(int day)
+{
+  return (time_t) day * SECSINDAY;
+}
+
+bool cEpgCache::ParseGuid(const std::string& str, uint8_t guid[16])
+{
+  // Format: xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx
+  memset(guid, 0, 16);
+  int nibbles = 0;
+  for (std::string::const_iterator it = str.begin(); it != str.end(); ++it)
+  {
+    int value;
+    if (*it >= '0' && *it <= '9')
+      value = *it - '0';
+    else if (*it >= 'a' && *it <= 'f')
+      value = *it - 'a' + 10;
+    else if (*it >= 'A' && *it <= 'F')
+      value = *it - 'A' + 10;
+    else if (*it == '-')
+      continue;
+    else
+      return false;
+
+    if (nibbles == 32)
+      return false;
+    guid[nibbles / 2] |= (nibbles % 2 == 0) ? (value << 4) : value;
+    nibbles++;
+  }
+  return (nibbles == 32);
+}
+
+std::string cEpgCache::FormatGuid(const uint8_t guid[16])
+{
+  char buffer[37];
+  snprintf(buffer, sizeof(buffer), "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+    guid[0], guid[1], guid[2], guid[3], guid[4], guid[5], guid[6], guid[7],
+    guid[8], guid[9], guid[10], guid[11], guid[12], guid[13], guid[14], guid[15]);
+  return buffer;
+}
+
+bool cEpgCache::IsValid(const DayInfo& day, time_t now) const
+{
+  // Stale days are served until the revalidation has refetched them
+  return day.stale || ((now >= day.fetched) && (now - day.fetched < EPG_CACHE_BLOCK_TTL));
+}
+
+static bool CompareStart(const cEpgRecord& a, const cEpgRecord& b)
+{
+  return a.starttime < b.starttime;
+}
+
+void cEpgCache::Release(const cEpgRecord& record)
+{
+  m_strings.Release(record.title);
+  m_strings.Release(record.subtitle);
+  m_strings.Release(record.description);
+  m_strings.Release(record.genre);
+}
+
+void cEpgCache::Store(ChannelGuide& guide, int day, const std::vector<cEpg>& programs, time_t now)
+{
+  time_t dayStart = StartOfDay(day);
+  time_t dayEnd = StartOfDay(day + 1);
+
+  // A program belongs to the day it starts in; replace the previous contents of this day
+  std::vector<cEpgRecord>::iterator first = std::lower_bound(guide.programs.begin(), guide.programs.end(), dayStart, LessStart());
+  std::vector<cEpgRecord>::iterator last = std::lower_bound(first, guide.programs.end(), dayEnd, LessStart());
+  for (std::vector<cEpgRecord>::iterator it = first; it != last; ++it)
+    Release(*it);
+  m_records -= (last - first);
+  guide.programs.erase(first, last);
+
+  size_t count = guide.programs.size();
+  for (std::vector<cEpg>::const_iterator epg = programs.begin(); epg != programs.end(); ++epg)
+  {
+    if (epg->StartTime() >= dayEnd)
+      continue;
+    if (epg->StartTime() < dayStart)
+    {
+      // Started the day before; keep it only when that day did not already provide it
+      std::vector<cEpgRecord>::const_iterator it = std::lower_bound(guide.programs.begin(), guide.programs.begin() + count,
+        epg->StartTime(), LessStart());
+      if (it != guide.programs.begin() + count && it->starttime == (uint32_t) epg->StartTime())
+        continue;
+    }
+
+    cEpgRecord record;
+    ParseGuid(epg->UniqueId(), record.guid);
+    record.starttime   = (uint32_t) epg->StartTime();
+    record.endtime     = (uint32_t) epg->EndTime();
+    record.title       = m_strings.Add(epg->Title());
+    record.subtitle    = m_strings.Add(epg->Subtitle());
+    record.description = m_strings.Add(epg->Description());
+    record.genre       = m_strings.Add(epg->Genre());
+    guide.programs.push_back(record);
+  }
+  m_records += guide.programs.size() - count;
+  std::inplace_merge(guide.programs.begin(), guide.programs.begin() + count, guide.programs.end(), CompareStart);
+  Reindex(guide);
+
+  DayInfo& info = guide.days[day];
+  info.fetched = now;
+  info.lastused = m_sequence;
+  info.stale = false;
+}
+
+void cEpgCache::Evict(ChannelGuide& guide, int day)
+{
+  guide.days.erase(day);
+  bool nextCovered = (guide.days.find(day + 1) != guide.days.end());
+  bool prevCovered = (guide.days.find(day - 1) != guide.days.end());
+
+  // Remove the programs that start on this day, except those that run into a day that
+  // is still cached. Programs of an uncached previous day were only kept for this day.
+  time_t dayStart = StartOfDay(day);
+  time_t dayEnd = StartOfDay(day + 1);
+  std::vector<cEpgRecord>::iterator out = guide.programs.begin();
+  for (std::vector<cEpgRecord>::iterator it = guide.programs.begin(); it != guide.programs.end(); ++it)
+  {
+    bool remove = false;
+    if (it->starttime >= dayStart && it->starttime < dayEnd)
+      remove = !(nextCovered && it->endtime > dayEnd);
+    else if (it->starttime < dayStart && it->starttime >= dayStart - SECSINDAY)
+      remove = !prevCovered;
+
+    if (remove)
+    {
+      Release(*it);
+      m_records--;
+    }
+    else
+    {
+      *out++ = *it;
+    }
+  }
+  guide.programs.erase(out, guide.programs.end());
+  Reindex(guide);
+}
+
+void cEpgCache::Reindex(ChannelGuide& guide)
+{
+  guide.maxend.resize(guide.programs.size());
+  uint32_t maxend = 0;
+  for (size_t i = 0; i < guide.programs.size(); i++)
+  {
+    if (guide.programs[i].endtime > maxend)
+      maxend = guide.programs[i].endtime;
+    guide.maxend[i] = maxend;
+  }
+}
+
+size_t cEpgCache::FirstOverlap(const ChannelGuide& guide, time_t start)
+{
+  // No program before the first index whose maxend lies beyond start can overlap [start, ...)
+  return std::upper_bound(guide.maxend.begin(), guide.maxend.end(), (uint32_t) start) - guide.maxend.begin();
+}
+
+cEpgCache::eLookupResult cEpgCache::FindProgram(const std::string& guidechannelid, time_t start, time_t end, cEpg& program)
+{
+  if (end <= start)
+    end = start + 1;
+
+  CLockObject lock(m_mutex);
+  std::map<std::string, ChannelGuide>::const_iterator channel = m_channels.find(guidechannelid);
+  if (channel == m_channels.end())
+    return LOOKUP_NOT_CACHED;
+
+  const ChannelGuide& guide = channel->second;
+  for (int day = DayOf(start); day <= DayOf(end - 1); day++)
+  {
+    if (guide.days.find(day) == guide.days.end())
+      return LOOKUP_NOT_CACHED;
+  }
+
+  for (size_t i = FirstOverlap(guide, start); i < guide.programs.size() && (time_t) guide.programs[i].starttime < end; i++)
+  {
+    if ((time_t) guide.programs[i].endtime > start)
+    {
+      program = ToEpg(guide.programs[i]);
+      return LOOKUP_FOUND;
+    }
+  }
+  return LOOKUP_NONE;
+}
+
+cEpg cEpgCache::ToEpg(const cEpgRecord& record) const
+{
+  return cEpg(FormatGuid(record.guid), record.starttime, record.endtime, m_strings.Get(record.title),
+    m_strings.Get(record.subtitle), m_strings.Get(record.description), m_strings.Get(record.genre));
+}
+
+bool cEpgCache::GetPrograms(const std::string& guidechannelid, unsigned int channeluid, time_t start, time_t end, std::vector<cEpg>& programs)
+{
+  programs.clear();
+  time_t now = time(NULL);
+  time_t frameEnd;
+  {
+    // SetTimeFrame() changes m_timeframe from Kodi's settings thread
+    CLockObject lock(m_mutex);
+    frameEnd = TimeFrameEnd(now);
+    int back = std::min(DayOf(now) - DayOf(start), EPG_CACHE_MAX_PAST_DAYS);
+    if (back > m_pastdays)
+      m_pastdays = back;
+  }
+  if (frameEnd > 0 && end > frameEnd)
+    end = frameEnd;
+  if (end <= start)
+    return true;
+
+  if (g_iEpgCacheSize <= 0)
+  {
+    // Cache disabled, pass the window on to the server as is
+    return FetchPrograms(guidechannelid, start, end, programs);
+  }
+
+  int firstDay = DayOf(start);
+  int lastDay = DayOf(end - 1);
+
+  // Determine which days are missing or outdated
+  std::vector<CJob*> jobs;
+  {
+    CLockObject lock(m_mutex);
+    ChannelGuide& guide = m_channels[guidechannelid];
+    if (std::find(guide.clients.begin(), guide.clients.end(), channeluid) == guide.clients.end())
+      guide.clients.push_back(channeluid);
+    for (int day = firstDay; day <= lastDay; day++)
+    {
+      std::map<int, DayInfo>::const_iterator it = guide.days.find(day);
+      if (it == guide.days.end() || !IsValid(it->second, now))
+        jobs.push_back(new CFetchDayJob(guidechannelid, day, StartOfDay(day), StartOfDay(day + 1)));
+    }
+  }
+
+  bool bSuccess = true;
+  if (!jobs.empty())
+  {
+    XBMC->Log(LOG_DEBUG, "cEpgCache: fetching %d of %d day(s) for guide channel %s.",
+      (int) jobs.size(), lastDay - firstDay + 1, guidechannelid.c_str());
+
+    CJobPool pool(EPG_CACHE_FETCH_THREADS);
+    pool.Run(jobs);
+
+    CLockObject lock(m_mutex);
+    ChannelGuide& guide = m_channels[guidechannelid];
+    for (std::vector<CJob*>::iterator it = jobs.begin(); it != jobs.end(); ++it)
+    {
+      CFetchDayJob* job = static_cast<CFetchDayJob*>(*it);
+      if (job->Success())
+        Store(guide, job->Day(), job->Programs(), now);
+      else
+        bSuccess = false;
+      delete job;
+    }
+
+    size_t usage = Usage();
+    XBMC->Log(LOG_DEBUG, "cEpgCache: %d programs, %d strings, %d KB (%d KB per 10k programs).",
+      (int) m_records, (int) m_strings.Count(), (int) (usage / 1024),
+      m_records ? (int) (usage / 1024 * 10000 / m_records) : 0);
+  }
+
+  {
+    CLockObject lock(m_mutex);
+    m_sequence++;
+    ChannelGuide& guide = m_channels[guidechannelid];
+    for (int day = firstDay; day <= lastDay; day++)
+    {
+      std::map<int, DayInfo>::iterator it = guide.days.find(day);
+      if (it != guide.days.end())
+        it->second.lastused = m_sequence;
+    }
+
+    for (size_t i = FirstOverlap(guide, start); i < guide.programs.size() && (time_t) guide.programs[i].starttime < end; i++)
+    {
+      if ((time_t) guide.programs[i].endtime > start)
+        programs.push_back(ToEpg(guide.programs[i]));
+    }
+
+    // Days move out of the frame while the add-on runs
+    EvictOutside(now);
+    Trim();
+  }
+
+  return bSuccess;
+}
+
+uint64_t cEpgCache::Checksum(const ChannelGuide& guide, int day) const
+{
+  // FNV-1a over the programs that start on this day
+  uint64_t hash = 14695981039346656037ULL;
+  std::vector<cEpgRecord>::const_iterator it = std::lower_bound(guide.programs.begin(), guide.programs.end(), StartOfDay(day), LessStart());
+  for (; it != guide.programs.end() && (time_t) it->starttime < StartOfDay(day + 1); ++it)
+  {
+    const std::string& title = m_strings.Get(it->title);
+    const uint8_t* parts[3] = { it->guid, (const uint8_t*) &it->starttime, (const uint8_t*) title.data() };
+    size_t sizes[3] = { sizeof(it->guid), 2 * sizeof(uint32_t), title.length() };
+    for (int part = 0; part < 3; part++)
+    {
+      for (size_t i = 0; i < sizes[part]; i++)
+      {
+        hash ^= parts[part][i];
+        hash *= 1099511628211ULL;
+      }
+    }
+  }
+  return hash;
+}
+
+bool cEpgCache::RevalidateNext(void)
+{
+  std::string guidechannelid;
+  std::vector<unsigned int> clients;
+  std::vector<CJob*> jobs;
+  {
+    CLockObject lock(m_mutex);
+    for (std::map<std::string, ChannelGuide>::const_iterator channel = m_channels.begin(); channel != m_channels.end() && jobs.empty(); ++channel)
+    {
+      for (std::map<int, DayInfo>::const_iterator day = channel->second.days.begin(); day != channel->second.days.end(); ++day)
+      {
+        if (day->second.stale)
+          jobs.push_back(new CFetchDayJob(channel->first, day->first, StartOfDay(day->first), StartOfDay(day->first + 1)));
+      }
+      guidechannelid = channel->first;
+      clients = channel->second.clients;
+    }
+  }
+  if (jobs.empty())
+    return false;
+
+  CJobPool pool(EPG_CACHE_FETCH_THREADS);
+  pool.Run(jobs);
+
+  bool bChanged = false;
+  {
+    CLockObject lock(m_mutex);
+    time_t now = time(NULL);
+    std::map<std::string, ChannelGuide>::iterator channel = m_channels.find(guidechannelid);
+    for (std::vector<CJob*>::iterator it = jobs.begin(); it != jobs.end(); ++it)
+    {
+      CFetchDayJob* job = static_cast<CFetchDayJob*>(*it);
+      if (channel != m_channels.end())
+      {
+        std::map<int, DayInfo>::iterator day = channel->second.days.find(job->Day());
+        // Skip days that were dropped or refetched in the meantime
+        if (day != channel->second.days.end() && day->second.stale)
+        {
+          if (job->Success())
+          {
+            uint64_t before = Checksum(channel->second, job->Day());
+            Store(channel->second, job->Day(), job->Programs(), now);
+            bChanged |= (Checksum(channel->second, job->Day()) != before);
+          }
+          else
+          {
+            // Let the next request fetch it
+            day->second.stale = false;
+            day->second.fetched = 0;
+          }
+        }
+      }
+      delete job;
+    }
+  }
+
+  if (bChanged)
+  {
+    XBMC->Log(LOG_DEBUG, "cEpgCache: guide channel %s changed since the cache was saved.", guidechannelid.c_str());
+    for (std::vector<unsigned int>::const_iterator it = clients.begin(); it != clients.end(); ++it)
+      PVR->TriggerEpgUpdate(*it);
+  }
+  return true;
+}
+
+bool cEpgCache::Save(const std::string& filename)
+{
+  CLockObject lock(m_mutex);
+
+  std::string tmpname = filename + ".tmp";
+  FILE* file = fopen(tmpname.c_str(), "wb");
+  if (file == NULL)
+  {
+    XBMC->Log(LOG_ERROR, "cEpgCache: can not open %s for writing.", tmpname.c_str());
+    return false;
+  }
+
+  FileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, EPG_CACHE_FILE_MAGIC, sizeof(header.magic));
+  header.version = EPG_CACHE_FILE_VERSION;
+  header.byteorder = EPG_CACHE_BYTE_ORDER;
+  header.recordsize = sizeof(cEpgRecord);
+  header.stringcount = m_strings.IdCount();
+  header.channelcount = (uint32_t) m_channels.size();
+  header.saved = (int64_t) time(NULL);
+
+  // The string table is indexed by pool id, so records are written as they are
+  bool bOk = (fwrite(&header, sizeof(header), 1, file) == 1);
+  for (uint32_t id = 0; bOk && id < header.stringcount; id++)
+    bOk = WriteString(file, m_strings.Get(id));
+
+  for (std::map<std::string, ChannelGuide>::const_iterator channel = m_channels.begin(); bOk && channel != m_channels.end(); ++channel)
+  {
+    const ChannelGuide& guide = channel->second;
+    uint32_t clientcount = (uint32_t) guide.clients.size();
+    uint32_t daycount = (uint32_t) guide.days.size();
+    uint32_t programcount = (uint32_t) guide.programs.size();
+
+    bOk = WriteString(file, channel->first)
+      && fwrite(&clientcount, sizeof(clientcount), 1, file) == 1
+      && (clientcount == 0 || fwrite(&guide.clients[0], sizeof(uint32_t), clientcount, file) == clientcount)
+      && fwrite(&daycount, sizeof(daycount), 1, file) == 1;
+    for (std::map<int, DayInfo>::const_iterator day = guide.days.begin(); bOk && day != guide.days.end(); ++day)
+    {
+      int32_t value = day->first;
+      bOk = (fwrite(&value, sizeof(value), 1, file) == 1);
+    }
+    bOk = bOk && fwrite(&programcount, sizeof(programcount), 1, file) == 1
+      && (programcount == 0 || fwrite(&guide.programs[0], sizeof(cEpgRecord), programcount, file) == programcount);
+  }
+
+  if (fclose(file) != 0)
+    bOk = false;
+  if (!bOk)
+  {
+    XBMC->Log(LOG_ERROR, "cEpgCache: error writing %s.", tmpname.c_str());
+    remove(tmpname.c_str());
+    return false;
+  }
+
+#if defined(TARGET_WINDOWS)
+  // rename does not replace an existing file on Windows
+  remove(filename.c_str());
+#endif
+  if (rename(tmpname.c_str(), filename.c_str()) != 0)
+  {
+    XBMC->Log(LOG_ERROR, "cEpgCache: can not rename %s to %s.", tmpname.c_str(), filename.c_str());
+    remove(tmpname.c_str());
+    return false;
+  }
+
+  XBMC->Log(LOG_INFO, "cEpgCache: saved %d programs of %d guide channels to %s.", (int) m_records, (int) m_channels.size(), filename.c_str());
+  return true;
+}
+
+bool cEpgCache::Load(const std::string& filename)
+{
+  CMappedFile mapped;
+  if (!mapped.Open(filename))
+  {
+    XBMC->Log(LOG_DEBUG, "cEpgCache: no cache file %s.", filename.c_str());
+    return false;
+  }
+
+  CFileCursor cursor(mapped.Data(), mapped.Size());
+  FileHeader header;
+  if (!cursor.Read(&header, sizeof(header))
+    || memcmp(header.magic, EPG_CACHE_FILE_MAGIC, sizeof(header.magic)) != 0
+    || header.version != EPG_CACHE_FILE_VERSION
+    || header.byteorder != EPG_CACHE_BYTE_ORDER
+    || header.recordsize != sizeof(cEpgRecord)
+    || header.stringcount > mapped.Size() / sizeof(uint32_t))
+  {
+    XBMC->Log(LOG_NOTICE, "cEpgCache: ignoring %s, unknown format.", filename.c_str());
+    return false;
+  }
+
+  CLockObject lock(m_mutex);
+  m_channels.clear();
+  m_strings.Clear();
+  m_records = 0;
+
+  // Intern the string table; the records refer to the ids as they were when saved
+  bool bOk = true;
+  std::vector<uint32_t> ids(header.stringcount, 0);
+  std::vector<std::string> strings(header.stringcount);
+  for (uint32_t id = 0; bOk && id < header.stringcount; id++)
+    bOk = cursor.ReadString(strings[id]);
+
+  std::vector<cEpgRecord> records;
+  for (uint32_t index = 0; bOk && index < header.channelcount; index++)
+  {
+    std::string guidechannelid;
+    uint32_t clientcount = 0, daycount = 0, programcount = 0;
+    bOk = cursor.ReadString(guidechannelid) && cursor.Read(&clientcount, sizeof(clientcount))
+      && clientcount <= mapped.Size() / sizeof(uint32_t);
+    if (!bOk)
+      break;
+
+    ChannelGuide& guide = m_channels[guidechannelid];
+    guide.clients.resize(clientcount);
+    bOk = (clientcount == 0 || cursor.Read(&guide.clients[0], clientcount * sizeof(uint32_t)))
+      && cursor.Read(&daycount, sizeof(daycount));
+    for (uint32_t i = 0; bOk && i < daycount; i++)
+    {
+      int32_t day;
+      bOk = cursor.Read(&day, sizeof(day));
+      DayInfo& info = guide.days[day];
+      info.fetched = (time_t) header.saved;
+      info.lastused = 0;
+      info.stale = true;
+    }
+    bOk = bOk && cursor.Read(&programcount, sizeof(programcount))
+      && programcount <= mapped.Size() / sizeof(cEpgRecord);
+    if (!bOk)
+      break;
+
+    guide.programs.resize(programcount);
+    bOk = (programcount == 0 || cursor.Read(&guide.programs[0], programcount * sizeof(cEpgRecord)));
+    for (std::vector<cEpgRecord>::iterator it = guide.programs.begin(); bOk && it != guide.programs.end(); ++it)
+    {
+      uint32_t* fields[4] = { &it->title, &it->subtitle, &it->description, &it->genre };
+      for (int i = 0; bOk && i < 4; i++)
+      {
+        uint32_t id = *fields[i];
+        if (id >= header.stringcount)
+        {
+          bOk = false;
+        }
+        else
+        {
+          if (ids[id] == 0)
+            ids[id] = m_strings.Add(strings[id]);
+          else
+            m_strings.AddRef(ids[id]);
+          *fields[i] = ids[id];
+        }
+      }
+    }
+    m_records += guide.programs.size();
+    Reindex(guide);
+  }
+
+  if (!bOk)
+  {
+    XBMC->Log(LOG_ERROR, "cEpgCache: %s is damaged, ignoring it.", filename.c_str());
+    m_channels.clear();
+    m_strings.Clear();
+    m_records = 0;
+    return false;
+  }
+
+  XBMC->Log(LOG_INFO, "cEpgCache: loaded %d programs of %d guide channels from %s.", (int) m_records, (int) m_channels.size(), filename.c_str());
+  EvictOutside(time(NULL));
+  return true;
+}
+
+time_t cEpgCache::TimeFrameEnd(time_t now) const
+{
+  if (m_timeframe < 0)
+    return 0;
+  // Round up to whole days, the cache works with day blocks anyway
+  return StartOfDay(DayOf(now) + m_timeframe + 1);
+}
+
+void cEpgCache::SetTimeFrame(int days)
+{
+  CLockObject lock(m_mutex);
+  m_timeframe = (days < 0) ? EPG_TIMEFRAME_UNLIMITED : days;
+  EvictOutside(time(NULL));
+}
+
+void cEpgCache::EvictOutside(time_t now)
+{
+  int firstDay = DayOf(now) - m_pastdays;
+  time_t frameEnd = TimeFrameEnd(now);
+  int lastDay = (frameEnd > 0) ? DayOf(frameEnd - 1) : INT_MAX;
+  size_t before = m_records;
+  std::map<std::string, ChannelGuide>::iterator channel = m_channels.begin();
+  while (channel != m_channels.end())
+  {
+    ChannelGuide& guide = channel->second;
+    // Evict from the outer days inwards, so no program is kept for a neighbouring day that goes next
+    while (!guide.days.empty() && guide.days.rbegin()->first > lastDay)
+      Evict(guide, guide.days.rbegin()->first);
+    while (!guide.days.empty() && guide.days.begin()->first < firstDay)
+      Evict(guide, guide.days.begin()->first);
+
+    if (guide.days.empty())
+      m_channels.erase(channel++);
+    else
+      ++channel;
+  }
+  if (before != m_records)
+    XBMC->Log(LOG_DEBUG, "cEpgCache: dropped %d programs outside the EPG time frame.", (int) (before - m_records));
+}
+
+size_t cEpgCache::Usage(void) const
+{
+  return m_records * (sizeof(cEpgRecord) + sizeof(uint32_t)) + m_strings.MemoryUsage();
+}
+
+void cEpgCache::Trim(void)
+{
+  size_t maxSize = (size_t) g_iEpgCacheSize * 1024 * 1024;
+  while (Usage() > maxSize)
+  {
+    std::map<std::string, ChannelGuide>::iterator oldestChannel = m_channels.end();
+    int oldestDay = 0;
+    unsigned int oldestUse = 0;
+    for (std::map<std::string, ChannelGuide>::iterator channel = m_channels.begin(); channel != m_channels.end(); ++channel)
+    {
+      for (std::map<int, DayInfo>::const_iterator day = channel->second.days.begin(); day != channel->second.days.end(); ++day)
+      {
+        if (oldestChannel == m_channels.end() || day->second.lastused < oldestUse)
+        {
+          oldestChannel = channel;
+          oldestDay = day->first;
+          oldestUse = day->second.lastused;
+        }
+      }
+    }
+    if (oldestChannel == m_channels.end())
+      break;
+
+    Evict(oldestChannel->second, oldestDay);
+    if (oldestChannel->second.days.empty())
+      m_channels.erase(oldestChannel);
+  }
+}
+
+void cEpgCache::Clear(void)
+{
+  CLockObject lock(m_mutex);
+  XBMC->Log(LOG_DEBUG, "cEpgCache: dropping %d programs, %d KB.", (int) m_records, (int) (Usage() / 1024));
+  m_channels.clear();
+  m_strings.Clear();
+  m_records = 0;
+}
+
+size_t cEpgCache::MemoryUsage(void)
+{
+  CLockObject lock(m_mutex);
+  return Usage();
+}
@@ -0,0 +1,155 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "p8-platform/threads/mutex.h"
+#include "epg.h"
+#include "stringpool.h"
+
+/**
+ * \brief Compact representation of a guide program as stored in the EPG cache.
+ *        Strings are ids in the cache's string pool.
+ */
+struct cEpgRecord
+{
+  uint8_t  guid[16];   ///< GuideProgramId
+  uint32_t starttime;  ///< UTC, seconds since the epoch
+  uint32_t endtime;    ///< UTC, seconds since the epoch
+  uint32_t title;
+  uint32_t subtitle;
+  uint32_t description;
+  uint32_t genre;
+};
+
+/**
+ * \brief Cache of parsed guide programs. Per guide channel the programs are kept in one
+ *        array sorted by start time, together with the (UTC) days that have been fetched.
+ *        Requests for a time window are served from the cache, only the missing days are
+ *        fetched from the server. The least recently used days are dropped when the cache
+ *        grows beyond g_iEpgCacheSize megabytes.
+ *        The cache can be saved to and loaded from a binary file, so the guide is available
+ *        right after a restart. Loaded days are stale until RevalidateNext() refetched them.
+ */
+class cEpgCache
+{
+public:
+  cEpgCache(void);
+  virtual ~cEpgCache(void);
+
+  /**
+   * \brief Collect all programs of a guide channel that overlap [start, end), in start time order
+   * \param guidechannelid ARGUS guide channel id (not the channel id)
+   * \param channeluid     Kodi channel that requests the programs, used for EPG update triggers
+   * \param programs       Receives the programs
+   * \return false when (part of) the window could not be retrieved from the server
+   */
+  bool GetPrograms(const std::string& guidechannelid, unsigned int channeluid, time_t start, time_t end, std::vector<cEpg>& programs);
+
+  enum eLookupResult
+  {
+    LOOKUP_NOT_CACHED, ///< (part of) the window is not in the cache, ask the server
+    LOOKUP_NONE,       ///< the window is cached, no program overlaps it
+    LOOKUP_FOUND       ///< program holds the first program that overlaps the window
+  };
+
+  /**
+   * \brief Find the first program (by start time) of a guide channel that overlaps [start, end)
+   *        without contacting the server. When end <= start, the program that is on at start is returned.
+   */
+  eLookupResult FindProgram(const std::string& guidechannelid, time_t start, time_t end, cEpg& program);
+
+  /**
+   * \brief Forget all cached guide data, e.g. after the server reported new guide data
+   */
+  void Clear(void);
+
+  size_t MemoryUsage(void);
+
+  /**
+   * \brief Limit the guide data to the number of days Kodi shows ahead; EPG_TIMEFRAME_UNLIMITED removes the limit.
+   *        Requests beyond the time frame are clipped and cached days beyond it are dropped, as are
+   *        the days before the ones Kodi still asks for.
+   */
+  void SetTimeFrame(int days);
+
+  /**
+   * \brief Replace the cache contents by the contents of a file written by Save(). All days are stale.
+   */
+  bool Load(const std::string& filename);
+
+  /**
+   * \brief Write the cache contents to a file. A temporary file is renamed, so an interrupted
+   *        save never leaves a damaged file behind.
+   */
+  bool Save(const std::string& filename);
+
+  /**
+   * \brief Refetch the stale days of one guide channel and trigger an EPG update in Kodi when they changed
+   * \return false when there were no stale days left
+   */
+  bool RevalidateNext(void);
+
+  static bool ParseGuid(const std::string& str, uint8_t guid[16]);
+  static std::string FormatGuid(const uint8_t guid[16]);
+
+private:
+  struct DayInfo
+  {
+    time_t fetched;        // time the day was retrieved from the server
+    unsigned int lastused; // LRU sequence number
+    bool stale;            // loaded from file, still to be revalidated
+  };
+
+  struct ChannelGuide
+  {
+    std::vector<cEpgRecord> programs; // sorted by start time
+    std::vector<uint32_t> maxend;     // maxend[i]: latest end time of programs[0..i], for overlap searches
+    std::map<int, DayInfo> days;      // days that have been fetched
+    std::vector<unsigned int> clients; // Kodi channels that use this guide channel
+  };
+
+  static int DayOf(time_t t);
+  static time_t StartOfDay(int day);
+  bool IsValid(const DayInfo& day, time_t now) const;
+  void Store(ChannelGuide& guide, int day, const std::vector<cEpg>& programs, time_t now);
+  void Evict(ChannelGuide& guide, int day);
+  void EvictOutside(time_t now);         // call with m_mutex held
+  time_t TimeFrameEnd(time_t now) const; // call with m_mutex held
+  void Release(const cEpgRecord& record);
+  static void Reindex(ChannelGuide& guide);
+  static size_t FirstOverlap(const ChannelGuide& guide, time_t start);
+  uint64_t Checksum(const ChannelGuide& guide, int day) const;
+  cEpg ToEpg(const cEpgRecord& record) const;
+  size_t Usage(void) const;
+  void Trim(void);
+
+  P8PLATFORM::CMutex m_mutex;
+  std::map<std::string, ChannelGuide> m_channels;
+  cStringPool m_strings;
+  size_t m_records;
+  unsigned int m_sequence;
+  int m_timeframe; // days ahead, EPG_TIMEFRAME_UNLIMITED when not limited
+  int m_pastdays;  // days back Kodi asks for (its EPG linger time), days before them are dropped
+};
@@ -0,0 +1,198 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "DataNotifier.h"
+#include "client.h" //for XBMC->Log
+#include "utils.h"
+#include <algorithm> //std::min, std::max
+#include <errno.h>
+#include <string>
+#include "p8-platform/util/timeutils.h"
+
+#if defined(TARGET_LINUX)
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+using namespace ADDON;
+using namespace P8PLATFORM;
+
+// Shortest and default wait when the growth rate is not known yet (ms)
+#define MIN_DATA_WAIT     10
+#define DEFAULT_DATA_WAIT 40
+// Length of one growth rate measurement window (ms)
+#define RATE_WINDOW       500
+
+namespace ArgusTV
+{
+  CDataNotifier::CDataNotifier(void) :
+    m_inotifyFd(-1),
+    m_watch(-1),
+    m_rateStart(0),
+    m_rateBytes(0),
+    m_bytesPerMs(0),
+    m_underruns(0),
+    m_stalls(0),
+    m_waits(0),
+    m_notified(0),
+    m_waitedMs(0),
+    m_maxUnderrunMs(0)
+  {
+  }
+
+  CDataNotifier::~CDataNotifier(void)
+  {
+    Close();
+  }
+
+  void CDataNotifier::Open(const char* pszFileName)
+  {
+    Close();
+    m_rateStart = GetTimeMs();
+    m_rateBytes = 0;
+    m_bytesPerMs = 0;
+    m_underruns = m_stalls = m_waits = m_notified = 0;
+    m_waitedMs = m_maxUnderrunMs = 0;
+
+#if defined(TARGET_LINUX)
+    // Only a file in the local file system can be watched, smb:// and friends are predicted
+    std::string filename = pszFileName;
+    if (filename.empty() || filename[0] != '/')
+      return;
+
+    // The timeshift files live next to the buffer file, so watch the directory
+    std::string directory = filename.substr(0, filename.find_last_of('/') + 1);
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd < 0)
+    {
+      XBMC->Log(LOG_NOTICE, "CDataNotifier: inotify not available (error %d), waits are predicted.", errno);
+      return;
+    }
+    m_watch = inotify_add_watch(m_inotifyFd, directory.c_str(), IN_MODIFY | IN_CREATE);
+    if (m_watch < 0)
+    {
+      XBMC->Log(LOG_NOTICE, "CDataNotifier: can not watch %s (error %d), waits are predicted.", directory.c_str(), errno);
+      close(m_inotifyFd);
+      m_inotifyFd = -1;
+      return;
+    }
+    XBMC->Log(LOG_DEBUG, "CDataNotifier: watching %s.", directory.c_str());
+#else
+    NOTUSED(pszFileName);
+#endif
+  }
+
+  void CDataNotifier::Close(void)
+  {
+#if defined(TARGET_LINUX)
+    if (m_inotifyFd >= 0)
+    {
+      close(m_inotifyFd); // removes the watch as well
+      m_inotifyFd = -1;
+      m_watch = -1;
+    }
+#endif
+  }
+
+  void CDataNotifier::DataRead(unsigned long bytes)
+  {
+    m_rateBytes += bytes;
+    int64_t now = GetTimeMs();
+    int64_t elapsed = now - m_rateStart;
+    if (elapsed < RATE_WINDOW)
+      return;
+
+    double rate = (double) m_rateBytes / elapsed;
+    m_bytesPerMs = (m_bytesPerMs == 0) ? rate : 0.75 * m_bytesPerMs + 0.25 * rate;
+    m_rateStart = now;
+    m_rateBytes = 0;
+  }
+
+  unsigned long CDataNotifier::PredictWait(unsigned long bytesNeeded) const
+  {
+    if (m_bytesPerMs <= 0)
+      return DEFAULT_DATA_WAIT;
+    return std::max((unsigned long) MIN_DATA_WAIT, (unsigned long) (bytesNeeded / m_bytesPerMs));
+  }
+
+  bool CDataNotifier::Wait(unsigned long bytesNeeded, unsigned long maxWaitMs)
+  {
+    unsigned long timeout = std::min(PredictWait(bytesNeeded), maxWaitMs);
+    int64_t start = GetTimeMs();
+
+#if defined(TARGET_LINUX)
+    // The notification normally ends the wait; the prediction (with some slack) is only a safety net
+    if (m_inotifyFd >= 0)
+      timeout = std::min(std::max(2 * timeout, (unsigned long) 50), maxWaitMs);
+#endif
+    bool notified = Poll(timeout);
+
+    m_waits++;
+    if (notified)
+      m_notified++;
+    m_waitedMs += GetTimeMs() - start;
+    return notified;
+  }
+
+  bool CDataNotifier::WaitForChange(unsigned long maxWaitMs)
+  {
+    bool notified = Poll(maxWaitMs);
+    m_rateStart = GetTimeMs();
+    m_rateBytes = 0;
+    return notified;
+  }
+
+  bool CDataNotifier::Poll(unsigned long timeoutMs)
+  {
+#if defined(TARGET_LINUX)
+    if (m_inotifyFd >= 0)
+    {
+      struct pollfd pfd;
+      pfd.fd = m_inotifyFd;
+      pfd.events = POLLIN;
+      pfd.revents = 0;
+      if (poll(&pfd, 1, (int) timeoutMs) <= 0)
+        return false;
+      char events[4096];
+      while (read(m_inotifyFd, events, sizeof(events)) > 0)
+        ;
+      return true;
+    }
+#endif
+    usleep(timeoutMs * 1000);
+    return false;
+  }
+
+  void CDataNotifier::Underrun(int64_t durationMs, bool stalled)
+  {
+    m_underruns++;
+    if (stalled)
+      m_stalls++;
+    m_maxUnderrunMs = std::max(m_maxUnderrunMs, durationMs);
+  }
+
+  void CDataNotifier::LogStatistics(void)
+  {
+    XBMC->Log(LOG_INFO, "CDataNotifier: %u underruns (%u stalled, longest %d ms), %u waits (%u woken by the file system) took %d ms, growth rate %d kB/s.",
+      m_underruns, m_stalls, (int) m_maxUnderrunMs, m_waits, m_notified, (int) m_waitedMs, (int) m_bytesPerMs);
+  }
+}
@@ -0,0 +1,93 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "p8-platform/os.h"
+
+namespace ArgusTV
+{
+  /**
+   * \brief Wakes a reader that caught up with a growing (timeshift) file as soon as more data
+   *        is likely to be there. Local files are watched with inotify (Linux); for other files
+   *        the wait is predicted from the rate at which the reader consumed data so far.
+   *        Also keeps the underrun statistics of one playback session.
+   */
+  class CDataNotifier
+  {
+  public:
+    CDataNotifier(void);
+    ~CDataNotifier(void);
+
+    /**
+     * \brief Start watching the directory of a growing file; the statistics start from zero
+     */
+    void Open(const char* pszFileName);
+    void Close(void);
+
+    /**
+     * \brief Account data handed to the reader, used to estimate the growth rate of the file
+     */
+    void DataRead(unsigned long bytes);
+
+    /**
+     * \brief Wait until about bytesNeeded more bytes should be available, at most maxWaitMs
+     * \return true when the wait ended because the file was written to
+     */
+    bool Wait(unsigned long bytesNeeded, unsigned long maxWaitMs);
+
+    /**
+     * \brief Wait until a file in the watched directory is written to or created, at most maxWaitMs.
+     *        Without a watch this sleeps maxWaitMs. Not counted in the statistics, and the growth rate
+     *        is measured from the end of the wait.
+     * \return true when the wait ended because the file system reported a change
+     */
+    bool WaitForChange(unsigned long maxWaitMs);
+
+    /**
+     * \brief Account a read that had to wait for data
+     * \param durationMs time from the first wait until the read returned
+     * \param stalled    the read gave up and returned less data than requested
+     */
+    void Underrun(int64_t durationMs, bool stalled);
+
+    void LogStatistics(void);
+
+  private:
+    unsigned long PredictWait(unsigned long bytesNeeded) const;
+    bool Poll(unsigned long timeoutMs);
+
+    int      m_inotifyFd;
+    int      m_watch;
+
+    // growth rate estimate
+    int64_t  m_rateStart;     // start of the current measurement window
+    uint64_t m_rateBytes;     // bytes read in the current measurement window
+    double   m_bytesPerMs;    // smoothed rate, 0 when unknown
+
+    // statistics of this session
+    unsigned int m_underruns;
+    unsigned int m_stalls;
+    unsigned int m_waits;
+    unsigned int m_notified;
+    int64_t      m_waitedMs;
+    int64_t      m_maxUnderrunMs;
+  };
+}
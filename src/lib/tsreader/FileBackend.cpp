@@ -0,0 +1,146 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "FileBackend.h"
+#include "LocalFileBackend.h"
+#include "MappedFileBackend.h"
+#include "UringFileBackend.h"
+#include "client.h" //for XBMC->Log
+#include "utils.h"
+
+using namespace ADDON;
+
+namespace ArgusTV
+{
+  /* indicate that caller can handle truncated reads, where function returns before entire buffer has been filled */
+#define READ_TRUNCATED 0x01
+
+  /* indicate that that caller support read in the minimum defined chunk size, this disables internal cache then */
+#define READ_CHUNKED   0x02
+
+  /* use cache to access this file */
+#define READ_CACHED     0x04
+
+  /* open without caching. regardless to file type. */
+#define READ_NO_CACHE  0x08
+
+  /* calcuate bitrate for file while reading */
+#define READ_BITRATE   0x10
+
+#if !defined(TARGET_WINDOWS)
+  static CFileBackend* TryOpen(CFileBackend* backend, const char* pszFileName)
+  {
+    if (backend->Open(pszFileName))
+      return backend;
+    delete backend;
+    return NULL;
+  }
+#endif
+
+  CFileBackend* CFileBackend::OpenFile(const char* pszFileName, bool bStreaming)
+  {
+#if !defined(TARGET_WINDOWS)
+    std::string localname;
+    if (ToLocalPath(pszFileName, localname))
+    {
+      CFileBackend* local = NULL;
+#if defined(HAVE_IO_URING)
+      if (bStreaming)
+        local = TryOpen(new CUringFileBackend(), localname.c_str());
+#endif
+      if (!local && bStreaming)
+        local = TryOpen(new CMappedFileBackend(), localname.c_str());
+      if (!local)
+        local = TryOpen(new CLocalFileBackend(), localname.c_str());
+      if (local)
+        return local;
+      XBMC->Log(LOG_NOTICE, "CFileBackend: local path %s of %s can not be opened, using %s.", localname.c_str(), pszFileName, pszFileName);
+    }
+#endif
+
+    CFileBackend* vfs = new CVfsFileBackend();
+    if (vfs->Open(pszFileName))
+      return vfs;
+    delete vfs;
+    return NULL;
+  }
+
+  bool CFileBackend::GetFileLength(const char* pszFileName, int64_t& length)
+  {
+#if !defined(TARGET_WINDOWS)
+    std::string localname;
+    if (ToLocalPath(pszFileName, localname) && CLocalFileBackend::GetFileLength(localname.c_str(), length))
+      return true;
+#endif
+
+    struct __stat64 stat;
+    if (XBMC->StatFile(pszFileName, &stat) != 0)
+      return false;
+    length = stat.st_size;
+    return true;
+  }
+
+  CVfsFileBackend::CVfsFileBackend(void) :
+    m_hFile(NULL)
+  {
+  }
+
+  CVfsFileBackend::~CVfsFileBackend(void)
+  {
+    Close();
+  }
+
+  bool CVfsFileBackend::Open(const char* pszFileName)
+  {
+    m_hFile = XBMC->OpenFile(pszFileName, READ_CHUNKED);
+    return m_hFile != NULL;
+  }
+
+  void CVfsFileBackend::Close(void)
+  {
+    if (m_hFile)
+    {
+      XBMC->CloseFile(m_hFile);
+      m_hFile = NULL;
+    }
+  }
+
+  unsigned long CVfsFileBackend::Read(unsigned char* pbData, unsigned long lDataLength)
+  {
+    ssize_t read = XBMC->ReadFile(m_hFile, (void*)pbData, lDataLength);
+    return read > 0 ? (unsigned long) read : 0;
+  }
+
+  int64_t CVfsFileBackend::Seek(int64_t llDistanceToMove, unsigned long dwMoveMethod)
+  {
+    return XBMC->SeekFile(m_hFile, llDistanceToMove, dwMoveMethod);
+  }
+
+  int64_t CVfsFileBackend::GetPosition(void)
+  {
+    return XBMC->GetFilePosition(m_hFile);
+  }
+
+  int64_t CVfsFileBackend::GetLength(void)
+  {
+    return XBMC->GetFileLength(m_hFile);
+  }
+}
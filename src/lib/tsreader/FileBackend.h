@@ -0,0 +1,90 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "p8-platform/os.h"
+
+namespace ArgusTV
+{
+  /**
+   * \brief The way a FileReader gets at the bytes of a file. Files on a share that has a
+   *        local path (the "localpaths" setting) are read directly, everything else goes
+   *        through Kodi's VFS.
+   */
+  class CFileBackend
+  {
+  public:
+    virtual ~CFileBackend(void) {}
+
+    virtual bool Open(const char* pszFileName) = 0;
+    virtual void Close(void) = 0;
+    /**
+     * \brief Read at the current position
+     * \return the number of bytes read, 0 at the end of the file or on an error
+     */
+    virtual unsigned long Read(unsigned char* pbData, unsigned long lDataLength) = 0;
+    /**
+     * \param dwMoveMethod FILE_BEGIN, FILE_CURRENT or FILE_END
+     * \return the new position, -1 on an error
+     */
+    virtual int64_t Seek(int64_t llDistanceToMove, unsigned long dwMoveMethod) = 0;
+    virtual int64_t GetPosition(void) = 0;
+    virtual int64_t GetLength(void) = 0;
+    /**
+     * \brief Hint that the file with this local path is read after this one (the next timeshift segment)
+     */
+    virtual void PrepareNext(const char* /*pszFileName*/) {}
+
+    /**
+     * \brief Open a file with the best backend for it; falls back to the VFS when the local path fails
+     * \param bStreaming the file is read front to back (timeshift segments); when it has
+     *        a local path it is read ahead with io_uring, or memory mapped when io_uring is not available,
+     *        or read with blocking reads when the file system can not map it either
+     * \return NULL when the file can not be opened
+     */
+    static CFileBackend* OpenFile(const char* pszFileName, bool bStreaming = false);
+
+    /**
+     * \brief Size of a file that is not opened
+     */
+    static bool GetFileLength(const char* pszFileName, int64_t& length);
+  };
+
+  /**
+   * \brief Reads through Kodi's VFS (smb://, UNC names on Windows, local files)
+   */
+  class CVfsFileBackend : public CFileBackend
+  {
+  public:
+    CVfsFileBackend(void);
+    virtual ~CVfsFileBackend(void);
+
+    virtual bool Open(const char* pszFileName);
+    virtual void Close(void);
+    virtual unsigned long Read(unsigned char* pbData, unsigned long lDataLength);
+    virtual int64_t Seek(int64_t llDistanceToMove, unsigned long dwMoveMethod);
+    virtual int64_t GetPosition(void);
+    virtual int64_t GetLength(void);
+
+  private:
+    void* m_hFile;
+  };
+}
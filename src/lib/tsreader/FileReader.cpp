@@ -34,6 +34,7 @@
 
 #include "FileReader.h"
 #include "client.h" //for XBMC->Log
+#include "utils.h"
 #include <algorithm> //std::min, std::max
 #include "p8-platform/util/timeutils.h" // for usleep
 
@@ -42,27 +43,13 @@ using namespace ADDON;
 namespace ArgusTV
 {
 
-  /* indicate that caller can handle truncated reads, where function returns before entire buffer has been filled */
-#define READ_TRUNCATED 0x01
-
-  /* indicate that that caller support read in the minimum defined chunk size, this disables internal cache then */
-#define READ_CHUNKED   0x02
-
-  /* use cache to access this file */
-#define READ_CACHED     0x04
-
-  /* open without caching. regardless to file type. */
-#define READ_NO_CACHE  0x08
-
-  /* calcuate bitrate for file while reading */
-#define READ_BITRATE   0x10
-
   FileReader::FileReader() :
-    m_hFile(NULL),
+    m_backend(NULL),
     m_pFileName(0),
     m_fileSize(0),
     m_fileStartPos(0),
-    m_bDebugOutput(false)
+    m_bDebugOutput(false),
+    m_bStreaming(false)
   {
   }
 
@@ -130,10 +117,10 @@ namespace ArgusTV
     do
     {
       XBMC->Log(LOG_INFO, "FileReader::OpenFile() %s.", m_pFileName);
-      void* fileHandle = XBMC->OpenFile(m_pFileName, READ_CHUNKED);
-      if (fileHandle)
+      CFileBackend* backend = CFileBackend::OpenFile(m_pFileName, m_bStreaming);
+      if (backend)
       {
-        m_hFile = fileHandle;
+        m_backend = backend;
         break;
       }
 
@@ -171,10 +158,11 @@ namespace ArgusTV
       return S_OK;
     }
 
-    if (m_hFile)
+    if (m_backend)
     {
-      XBMC->CloseFile(m_hFile);
-      m_hFile = NULL;
+      m_backend->Close();
+      delete m_backend;
+      m_backend = NULL;
     }
 
     return S_OK;
@@ -183,13 +171,13 @@ namespace ArgusTV
 
   inline bool FileReader::IsFileInvalid()
   {
-    return m_hFile == NULL;
+    return m_backend == NULL;
   }
 
   int64_t FileReader::SetFilePointer(int64_t llDistanceToMove, unsigned long dwMoveMethod)
   {
     //XBMC->Log(LOG_DEBUG, "%s: distance %d method %d.", __FUNCTION__, llDistanceToMove, dwMoveMethod);
-    int64_t rc = XBMC->SeekFile(m_hFile, llDistanceToMove, dwMoveMethod);
+    int64_t rc = m_backend->Seek(llDistanceToMove, dwMoveMethod);
     //XBMC->Log(LOG_DEBUG, "%s: distance %d method %d returns %d.", __FUNCTION__, llDistanceToMove, dwMoveMethod, rc);
     return rc;
   }
@@ -197,13 +185,13 @@ namespace ArgusTV
 
   int64_t FileReader::GetFilePointer()
   {
-    return XBMC->GetFilePosition(m_hFile);
+    return m_backend->GetPosition();
   }
 
 
   long FileReader::Read(unsigned char* pbData, unsigned long lDataLength, unsigned long *dwReadBytes)
   {
-    *dwReadBytes = XBMC->ReadFile(m_hFile, (void*)pbData, lDataLength);//Read file data into buffer
+    *dwReadBytes = m_backend->Read(pbData, lDataLength);//Read file data into buffer
     //XBMC->Log(LOG_DEBUG, "%s: requested read length %d actually read %d.", __FUNCTION__, lDataLength, *dwReadBytes);
 
     if (*dwReadBytes < lDataLength)
@@ -214,6 +202,13 @@ namespace ArgusTV
     return S_OK;
   }
 
+  void FileReader::PrepareNext(const char* pszFileName)
+  {
+    std::string localname;
+    if (m_backend && ToLocalPath(pszFileName, localname))
+      m_backend->PrepareNext(localname.c_str());
+  }
+
   void FileReader::SetDebugOutput(bool bDebugOutput)
   {
     m_bDebugOutput = bDebugOutput;
@@ -221,7 +216,7 @@ namespace ArgusTV
 
   int64_t FileReader::GetFileSize()
   {
-    return XBMC->GetFileLength(m_hFile);
+    return m_backend->GetLength();
   }
 
   void FileReader::OnZap(void)
@@ -34,6 +34,7 @@
  */
 
 #include "p8-platform/os.h"
+#include "FileBackend.h"
 
 namespace ArgusTV
 {
@@ -55,15 +56,25 @@ namespace ArgusTV
       virtual void OnZap(void);
       virtual int64_t GetFileSize();
       virtual bool IsBuffer(){ return false; };
+      virtual int64_t GetOpenWaitTime(){ return 0; };
 
       void SetDebugOutput(bool bDebugOutput);
+      /**
+       * \brief The file is read front to back, see CFileBackend::OpenFile()
+       */
+      void SetStreaming(bool bStreaming) { m_bStreaming = bStreaming; }
+      /**
+       * \brief Start reading the file that is read after this one, when it has a local path
+       */
+      void PrepareNext(const char* pszFileName);
 
   protected:
-      void*    m_hFile;               // Handle to file for streaming
+      CFileBackend* m_backend;        // The opened file, NULL when closed
       char*    m_pFileName;           // The filename where we stream
       int64_t  m_fileSize;
       int64_t  m_fileStartPos;
 
       bool     m_bDebugOutput;
+      bool     m_bStreaming;
   };
 }
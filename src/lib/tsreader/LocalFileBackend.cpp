@@ -0,0 +1,186 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "LocalFileBackend.h"
+#include "client.h" //for XBMC->Log
+#include <algorithm> //std::min
+
+#if !defined(TARGET_WINDOWS)
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace ADDON;
+
+namespace ArgusTV
+{
+  // Size of the read-ahead reads
+#define LOCAL_READ_SIZE (1024 * 1024)
+  // Reads start at a multiple of this
+#define LOCAL_ALIGNMENT 4096
+
+  CLocalFileBackend::CLocalFileBackend(void) :
+    m_fd(-1),
+    m_position(0),
+    m_buffer(NULL),
+    m_bufferStart(0),
+    m_bufferLength(0)
+  {
+  }
+
+  CLocalFileBackend::~CLocalFileBackend(void)
+  {
+    Close();
+  }
+
+  bool CLocalFileBackend::Open(const char* pszFileName)
+  {
+    Close();
+    m_fd = open(pszFileName, O_RDONLY | O_CLOEXEC);
+    if (m_fd < 0)
+    {
+      XBMC->Log(LOG_DEBUG, "CLocalFileBackend: open %s failed (error %d: %s).", pszFileName, errno, strerror(errno));
+      return false;
+    }
+#if defined(POSIX_FADV_SEQUENTIAL)
+    // Larger kernel read-ahead; playback reads the file from front to back
+    posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    void* buffer = NULL;
+    if (posix_memalign(&buffer, LOCAL_ALIGNMENT, LOCAL_READ_SIZE) != 0)
+    {
+      Close();
+      return false;
+    }
+    m_buffer = (unsigned char*) buffer;
+    m_position = 0;
+    m_bufferLength = 0;
+    XBMC->Log(LOG_DEBUG, "CLocalFileBackend: reading %s directly.", pszFileName);
+    return true;
+  }
+
+  void CLocalFileBackend::Close(void)
+  {
+    if (m_fd >= 0)
+    {
+      close(m_fd);
+      m_fd = -1;
+    }
+    free(m_buffer);
+    m_buffer = NULL;
+    m_bufferLength = 0;
+  }
+
+  long CLocalFileBackend::ReadAt(unsigned char* pbData, unsigned long lDataLength, int64_t position)
+  {
+    ssize_t read;
+    do
+    {
+      read = pread(m_fd, pbData, lDataLength, (off_t) position);
+    } while (read < 0 && errno == EINTR);
+    if (read < 0)
+      XBMC->Log(LOG_ERROR, "CLocalFileBackend: read failed (error %d: %s).", errno, strerror(errno));
+    return (long) read;
+  }
+
+  unsigned long CLocalFileBackend::Read(unsigned char* pbData, unsigned long lDataLength)
+  {
+    unsigned long done = 0;
+    while (done < lDataLength && m_fd >= 0)
+    {
+      // Serve what the buffer has
+      if (m_position >= m_bufferStart && m_position < m_bufferStart + (int64_t) m_bufferLength)
+      {
+        unsigned long offset = (unsigned long) (m_position - m_bufferStart);
+        unsigned long count = std::min(lDataLength - done, m_bufferLength - offset);
+        memcpy(pbData + done, m_buffer + offset, count);
+        done += count;
+        m_position += count;
+        continue;
+      }
+
+      unsigned long remaining = lDataLength - done;
+      if (remaining >= LOCAL_READ_SIZE)
+      {
+        // No point in copying large reads twice
+        long read = ReadAt(pbData + done, remaining, m_position);
+        if (read <= 0)
+          break;
+        done += read;
+        m_position += read;
+        if ((unsigned long) read < remaining)
+          break; // end of the file, for now
+        continue;
+      }
+
+      // Fill the buffer from the aligned block that holds the position
+      int64_t start = m_position & ~((int64_t) LOCAL_ALIGNMENT - 1);
+      long read = ReadAt(m_buffer, LOCAL_READ_SIZE, start);
+      m_bufferStart = start;
+      m_bufferLength = read > 0 ? (unsigned long) read : 0;
+      if (m_position >= m_bufferStart + (int64_t) m_bufferLength)
+        break; // end of the file, for now
+    }
+    return done;
+  }
+
+  int64_t CLocalFileBackend::Seek(int64_t llDistanceToMove, unsigned long dwMoveMethod)
+  {
+    int64_t position;
+    if (dwMoveMethod == FILE_END)
+      position = GetLength() + llDistanceToMove;
+    else if (dwMoveMethod == FILE_CURRENT)
+      position = m_position + llDistanceToMove;
+    else
+      position = llDistanceToMove;
+    if (position < 0)
+      return -1;
+    m_position = position;
+    m_bufferLength = 0;
+    return m_position;
+  }
+
+  int64_t CLocalFileBackend::GetPosition(void)
+  {
+    return m_position;
+  }
+
+  int64_t CLocalFileBackend::GetLength(void)
+  {
+    struct stat st;
+    if (m_fd < 0 || fstat(m_fd, &st) != 0)
+      return -1;
+    return st.st_size;
+  }
+
+  bool CLocalFileBackend::GetFileLength(const char* pszFileName, int64_t& length)
+  {
+    struct stat st;
+    if (stat(pszFileName, &st) != 0)
+      return false;
+    length = st.st_size;
+    return true;
+  }
+}
+#endif
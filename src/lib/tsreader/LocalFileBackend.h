@@ -0,0 +1,58 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "FileBackend.h"
+
+namespace ArgusTV
+{
+  /**
+   * \brief Reads a file on a locally mounted share (or on the server itself) with pread(), without
+   *        Kodi's VFS and SMB client. Small reads are served from a read-ahead buffer that is filled
+   *        with large reads aligned to the page size; large reads go straight to the caller's buffer.
+   *        The buffer is dropped on every seek, so rewritten files (the .tsbuffer) are read fresh.
+   *        Not available on Windows, where Kodi opens UNC names natively.
+   */
+  class CLocalFileBackend : public CFileBackend
+  {
+  public:
+    CLocalFileBackend(void);
+    virtual ~CLocalFileBackend(void);
+
+    virtual bool Open(const char* pszFileName);
+    virtual void Close(void);
+    virtual unsigned long Read(unsigned char* pbData, unsigned long lDataLength);
+    virtual int64_t Seek(int64_t llDistanceToMove, unsigned long dwMoveMethod);
+    virtual int64_t GetPosition(void);
+    virtual int64_t GetLength(void);
+
+    static bool GetFileLength(const char* pszFileName, int64_t& length);
+
+  private:
+    long ReadAt(unsigned char* pbData, unsigned long lDataLength, int64_t position);
+
+    int            m_fd;
+    int64_t        m_position;
+    unsigned char* m_buffer;       // LOCAL_READ_SIZE bytes, page aligned
+    int64_t        m_bufferStart;  // file position of m_buffer[0]
+    unsigned long  m_bufferLength; // valid bytes in m_buffer
+  };
+}
@@ -0,0 +1,283 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "MappedFileBackend.h"
+#include "client.h" //for XBMC->Log
+#include <algorithm> //std::min
+
+#if !defined(TARGET_WINDOWS)
+#include <atomic>
+#include <errno.h>
+#include <fcntl.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace ADDON;
+
+namespace ArgusTV
+{
+  // Size of the mapped window, a multiple of the page size
+#define MAP_WINDOW (32 * 1024 * 1024)
+  // How far ahead of the reader pages are requested
+#define MAP_READAHEAD (4 * 1024 * 1024)
+  // Request the next pages when fewer than this are left of the requested range
+#define MAP_ADVISE_STEP (2 * 1024 * 1024)
+
+  namespace
+  {
+    // Set while the thread copies from a mapping
+    thread_local sigjmp_buf* volatile t_copyJump = NULL;
+    struct sigaction g_previousBus;
+
+    void OnBus(int sig, siginfo_t* info, void* context)
+    {
+      if (t_copyJump)
+        siglongjmp(*t_copyJump, 1);
+      // Not from a copy: put back the handler that was there before, the faulting instruction
+      // runs again and raises the signal for that one
+      sigaction(SIGBUS, &g_previousBus, NULL);
+    }
+
+    bool InstallBusHandler(void)
+    {
+      struct sigaction action;
+      memset(&action, 0, sizeof(action));
+      action.sa_sigaction = OnBus;
+      // SIGBUS stays unblocked in the handler, so the jump out of it does not have to restore the
+      // signal mask and the copy needs no system call
+      action.sa_flags = SA_SIGINFO | SA_NODEFER;
+      sigemptyset(&action.sa_mask);
+      if (sigaction(SIGBUS, &action, &g_previousBus) != 0)
+      {
+        XBMC->Log(LOG_ERROR, "CMappedFileBackend: installing the SIGBUS handler failed (error %d: %s).", errno, strerror(errno));
+        return false;
+      }
+      return true;
+    }
+
+    /**
+     * \brief memcpy from a mapping that fails instead of raising SIGBUS when the file was truncated
+     */
+    bool CopyMapped(unsigned char* pbData, const unsigned char* pbMapped, size_t count)
+    {
+      sigjmp_buf jump;
+      if (sigsetjmp(jump, 0) != 0)
+      {
+        t_copyJump = NULL;
+        return false;
+      }
+      t_copyJump = &jump;
+      std::atomic_signal_fence(std::memory_order_seq_cst);
+      memcpy(pbData, pbMapped, count);
+      std::atomic_signal_fence(std::memory_order_seq_cst);
+      t_copyJump = NULL;
+      return true;
+    }
+  }
+
+  CMappedFileBackend::CMappedFileBackend(void) :
+    m_fd(-1),
+    m_position(0),
+    m_size(0),
+    m_truncated(false),
+    m_map(NULL),
+    m_mapStart(0),
+    m_advised(0),
+    m_reads(0),
+    m_maps(0),
+    m_sizeChecks(0),
+    m_advices(0)
+  {
+  }
+
+  CMappedFileBackend::~CMappedFileBackend(void)
+  {
+    Close();
+  }
+
+  bool CMappedFileBackend::Open(const char* pszFileName)
+  {
+    // Without the handler a truncated segment would crash Kodi, let the caller use another backend
+    static const bool bBusHandler = InstallBusHandler();
+    if (!bBusHandler)
+      return false;
+
+    Close();
+    m_fd = open(pszFileName, O_RDONLY | O_CLOEXEC);
+    if (m_fd < 0)
+    {
+      XBMC->Log(LOG_DEBUG, "CMappedFileBackend: open %s failed (error %d: %s).", pszFileName, errno, strerror(errno));
+      return false;
+    }
+    m_position = 0;
+    m_size = 0;
+    m_truncated = false;
+    m_reads = m_maps = m_sizeChecks = m_advices = 0;
+    GetLength();
+    // Some file systems can not map files at all, let the caller use another backend
+    if (!Map(0))
+    {
+      close(m_fd);
+      m_fd = -1;
+      return false;
+    }
+    XBMC->Log(LOG_DEBUG, "CMappedFileBackend: mapping %s.", pszFileName);
+    return true;
+  }
+
+  void CMappedFileBackend::Close(void)
+  {
+    if (m_fd < 0)
+      return;
+    Unmap();
+    close(m_fd);
+    m_fd = -1;
+    XBMC->Log(LOG_DEBUG, "CMappedFileBackend: %lu reads, %lu mappings, %lu size checks, %lu read-ahead requests.",
+      m_reads, m_maps, m_sizeChecks, m_advices);
+  }
+
+  bool CMappedFileBackend::Map(int64_t position)
+  {
+    if (m_map && position >= m_mapStart && position < m_mapStart + MAP_WINDOW)
+      return true;
+
+    Unmap();
+    int64_t start = position - position % MAP_WINDOW;
+    void* map = mmap(NULL, MAP_WINDOW, PROT_READ, MAP_SHARED, m_fd, (off_t) start);
+    if (map == MAP_FAILED)
+    {
+      XBMC->Log(LOG_ERROR, "CMappedFileBackend: mmap failed (error %d: %s).", errno, strerror(errno));
+      return false;
+    }
+    m_map = (unsigned char*) map;
+    m_mapStart = start;
+    m_advised = position;
+    m_maps++;
+    madvise(m_map, MAP_WINDOW, MADV_SEQUENTIAL);
+    return true;
+  }
+
+  void CMappedFileBackend::Unmap(void)
+  {
+    if (m_map)
+    {
+      munmap(m_map, MAP_WINDOW);
+      m_map = NULL;
+    }
+  }
+
+  void CMappedFileBackend::Advise(int64_t end)
+  {
+    if (m_advised - end >= MAP_ADVISE_STEP)
+      return;
+
+    // Only what the file holds and the window covers. Near the end of a live file the pages were
+    // just written and are cached, so small ranges are not worth a system call.
+    int64_t windowEnd = m_mapStart + MAP_WINDOW;
+    int64_t from = std::max(m_advised, end);
+    int64_t to = std::min(std::min(end + MAP_READAHEAD, m_size), windowEnd);
+    if (to <= from || (to - from < MAP_ADVISE_STEP && to < windowEnd))
+      return;
+
+    // madvise wants a page aligned start
+    int64_t page = sysconf(_SC_PAGESIZE);
+    int64_t alignedFrom = from - (from - m_mapStart) % page;
+    madvise(m_map + (alignedFrom - m_mapStart), (size_t) (to - alignedFrom), MADV_WILLNEED);
+    m_advices++;
+    m_advised = to;
+  }
+
+  unsigned long CMappedFileBackend::Read(unsigned char* pbData, unsigned long lDataLength)
+  {
+    m_reads++;
+    unsigned long done = 0;
+    while (done < lDataLength && m_fd >= 0 && !m_truncated)
+    {
+      // Ask for the size only when the reader caught up with the one that is known
+      if (m_position >= m_size)
+      {
+        int64_t known = m_size;
+        if (GetLength() < 0)
+          break;
+        if (m_size < known)
+        {
+          XBMC->Log(LOG_DEBUG, "CMappedFileBackend: file shrank from %lld to %lld bytes, treating it as ended.",
+            (long long) known, (long long) m_size);
+          m_truncated = true;
+          break;
+        }
+        if (m_position >= m_size)
+          break;
+      }
+      if (!Map(m_position))
+        break;
+
+      int64_t available = std::min(m_size, m_mapStart + MAP_WINDOW) - m_position;
+      unsigned long count = (unsigned long) std::min((int64_t) (lDataLength - done), available);
+      Advise(m_position + count);
+      if (!CopyMapped(pbData + done, m_map + (m_position - m_mapStart), count))
+      {
+        XBMC->Log(LOG_DEBUG, "CMappedFileBackend: file was truncated below %lld bytes while reading, treating it as ended.",
+          (long long) (m_position + count));
+        m_truncated = true;
+        break;
+      }
+      done += count;
+      m_position += count;
+    }
+    return done;
+  }
+
+  int64_t CMappedFileBackend::Seek(int64_t llDistanceToMove, unsigned long dwMoveMethod)
+  {
+    int64_t position;
+    if (dwMoveMethod == FILE_END)
+      position = GetLength() + llDistanceToMove;
+    else if (dwMoveMethod == FILE_CURRENT)
+      position = m_position + llDistanceToMove;
+    else
+      position = llDistanceToMove;
+    if (position < 0)
+      return -1;
+    m_position = position;
+    return m_position;
+  }
+
+  int64_t CMappedFileBackend::GetPosition(void)
+  {
+    return m_position;
+  }
+
+  int64_t CMappedFileBackend::GetLength(void)
+  {
+    struct stat st;
+    if (m_fd < 0 || fstat(m_fd, &st) != 0)
+      return -1;
+    m_sizeChecks++;
+    m_size = st.st_size;
+    return m_size;
+  }
+}
+#endif
@@ -0,0 +1,70 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "FileBackend.h"
+
+namespace ArgusTV
+{
+  /**
+   * \brief Reads a local timeshift segment through a memory mapping: a read is one memcpy and
+   *        normally no system call. The file is mapped in windows of MAP_WINDOW bytes, so 32 bit
+   *        clients do not run out of address space. A window covers more than the file holds;
+   *        the part that is read grows with the file; the size is asked again only when the reader
+   *        caught up with it. Touching a mapped page beyond the end of the file raises SIGBUS, and
+   *        the server truncates segments it recycles at any time, so the copy runs under a SIGBUS
+   *        handler that aborts it; a file that shrank reads as ended. Pages ahead of the reader are
+   *        requested with madvise(WILLNEED). The mapping goes when the reader moves to the next
+   *        segment.
+   */
+  class CMappedFileBackend : public CFileBackend
+  {
+  public:
+    CMappedFileBackend(void);
+    virtual ~CMappedFileBackend(void);
+
+    virtual bool Open(const char* pszFileName);
+    virtual void Close(void);
+    virtual unsigned long Read(unsigned char* pbData, unsigned long lDataLength);
+    virtual int64_t Seek(int64_t llDistanceToMove, unsigned long dwMoveMethod);
+    virtual int64_t GetPosition(void);
+    virtual int64_t GetLength(void);
+
+  private:
+    bool Map(int64_t position);
+    void Unmap(void);
+    void Advise(int64_t end);
+
+    int            m_fd;
+    int64_t        m_position;
+    int64_t        m_size;       // file size at the last fstat
+    bool           m_truncated;  // the file shrank below the size that was known
+    unsigned char* m_map;        // the window, NULL when not mapped
+    int64_t        m_mapStart;   // file position of m_map[0]
+    int64_t        m_advised;    // end of the range that was requested with madvise(WILLNEED)
+
+    // statistics, logged on close
+    unsigned long  m_reads;
+    unsigned long  m_maps;
+    unsigned long  m_sizeChecks;
+    unsigned long  m_advices;
+  };
+}
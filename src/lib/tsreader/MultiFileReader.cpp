@@ -53,6 +53,17 @@ using namespace P8PLATFORM;
 
 //Maximum time in msec to wait for the buffer file to become available - Needed for DVB radio (this sometimes takes some time)
 #define MAX_BUFFER_TIMEOUT 1500
+//Maximum time in msec to wait for the buffer file to get contents
+#define MAX_EMPTY_TIMEOUT 10000
+//First and longest interval in msec to check the buffer file while waiting for it; a notifier ends the wait earlier
+#define BUFFER_POLL_INTERVAL 20
+#define MAX_BUFFER_POLL_INTERVAL 250
+//Time in msec after which the buffer file is read again, also when the reader is far from its end
+#define REFRESH_INTERVAL 1000
+//A read that gets this close (in bytes) to the end position reads the buffer file first
+#define REFRESH_DISTANCE (64 * 1024)
+//Distance in bytes to the end of a segment at which the next segment is read ahead
+#define PREPARE_NEXT_DISTANCE (4 * 1024 * 1024)
 
 namespace ArgusTV
 {
@@ -65,11 +76,21 @@ namespace ArgusTV
     m_endPosition = 0;
     m_currentReadPosition = 0;
     m_lastZapPosition = 0;
+    m_openWaitTime = 0;
+    m_notifier = NULL;
     m_filesAdded = 0;
     m_filesRemoved = 0;
     m_TSFileId = 0;
+    m_preparedFileId = 0;
     m_bDelay = 0;
     m_bDebugOutput = false;
+    m_lastRefresh = 0;
+    m_reads = 0;
+    m_refreshes = 0;
+    m_refreshesAtEnd = 0;
+    m_refreshesExact = 0;
+    m_refreshesTimed = 0;
+    m_TSFile.SetStreaming(true);
   }
 
   MultiFileReader::~MultiFileReader()
@@ -97,44 +118,59 @@ namespace ArgusTV
     char * bufferfilename;
     m_TSBufferFile.GetFileName(&bufferfilename);
 
-    struct __stat64 stat;
-    if (XBMC->StatFile(bufferfilename, &stat) != 0)
+    int64_t fileLength;
+    if (!CFileBackend::GetFileLength(bufferfilename, fileLength))
     {
       XBMC->Log(LOG_ERROR, "MultiFileReader: can not get stat from buffer file %s.", bufferfilename);
       return S_FALSE;
     }
 
-    int64_t fileLength = stat.st_size;
     XBMC->Log(LOG_DEBUG, "MultiFileReader: buffer file %s, stat.st_size %ld.", bufferfilename, fileLength);
 
+    // Wait until the server wrote to the file; the notifier wakes up as soon as it did
+    m_openWaitTime = 0;
     int retryCount = 0;
-    if (fileLength == 0) do
+    unsigned long interval = BUFFER_POLL_INTERVAL;
+    if (fileLength == 0)
     {
-      retryCount++;
-      XBMC->Log(LOG_DEBUG, "MultiFileReader: buffer file has zero length, closing, waiting 500 ms and re-opening. Try %d.", retryCount);
-      usleep(500000);
-      XBMC->StatFile(bufferfilename, &stat);
-      fileLength = stat.st_size;
-    } while (fileLength == 0 && retryCount < 20);
+      int64_t waitStart = P8PLATFORM::GetTimeMs();
+      XBMC->Log(LOG_DEBUG, "MultiFileReader: buffer file has zero length, waiting for it to grow.");
+      P8PLATFORM::CTimeout timeout(MAX_EMPTY_TIMEOUT);
+      do
+      {
+        retryCount++;
+        WaitForBufferFile(interval, timeout.TimeLeft());
+        CFileBackend::GetFileLength(bufferfilename, fileLength);
+      } while (fileLength == 0 && timeout.TimeLeft() > 0);
+      m_openWaitTime += P8PLATFORM::GetTimeMs() - waitStart;
+    }
     XBMC->Log(LOG_DEBUG, "MultiFileReader: buffer file %s, after %d retries stat.st_size returns %ld.", bufferfilename, retryCount, fileLength);
 
     long hr = m_TSBufferFile.OpenFile();
+    m_reads = m_refreshes = m_refreshesAtEnd = m_refreshesExact = m_refreshesTimed = 0;
 
+    int refreshCount = 0;
     if (RefreshTSBufferFile() == S_FALSE)
     {
       // For radio the buffer sometimes needs some time to become available, so wait and try it more than once
       P8PLATFORM::CTimeout timeout(MAX_BUFFER_TIMEOUT);
+      int64_t waitStart = P8PLATFORM::GetTimeMs();
+      interval = BUFFER_POLL_INTERVAL;
 
       do
       {
-        usleep(100000);
+        refreshCount++;
+        WaitForBufferFile(interval, timeout.TimeLeft());
         if (timeout.TimeLeft() == 0)
         {
           XBMC->Log(LOG_ERROR, "MultiFileReader: timed out while waiting for buffer file to become available");
           XBMC->QueueNotification(QUEUE_ERROR, "Time out while waiting for buffer file");
+          m_openWaitTime += P8PLATFORM::GetTimeMs() - waitStart;
           return S_FALSE;
         }
       } while (RefreshTSBufferFile() == S_FALSE);
+      m_openWaitTime += P8PLATFORM::GetTimeMs() - waitStart;
+      XBMC->Log(LOG_DEBUG, "MultiFileReader: buffer file available after %d refreshes.", refreshCount);
     }
 
     m_currentReadPosition = 0;
@@ -142,12 +178,28 @@ namespace ArgusTV
     return hr;
   }
 
+  void MultiFileReader::WaitForBufferFile(unsigned long& interval, unsigned long timeLeft)
+  {
+    unsigned long wait = std::max(std::min(interval, timeLeft), (unsigned long) 1);
+    if (m_notifier)
+      m_notifier->WaitForChange(wait);
+    else
+      usleep(wait * 1000);
+    interval = std::min(2 * interval, (unsigned long) MAX_BUFFER_POLL_INTERVAL);
+  }
+
   //
   // CloseFile
   //
   long MultiFileReader::CloseFile()
   {
     long hr;
+    if (m_reads > 0)
+    {
+      XBMC->Log(LOG_DEBUG, "MultiFileReader: %lu reads, %lu buffer file refreshes (%lu near the end, %lu exact, %lu timed).",
+        m_reads, m_refreshes, m_refreshesAtEnd, m_refreshesExact, m_refreshesTimed);
+      m_reads = 0;
+    }
     hr = m_TSBufferFile.CloseFile();
     hr = m_TSFile.CloseFile();
     std::vector<MultiFileReaderFile *>::iterator it;
@@ -156,6 +208,7 @@ namespace ArgusTV
       delete (*it);
     }
     m_TSFileId = 0;
+    m_preparedFileId = 0;
     return hr;
   }
 
@@ -166,7 +219,9 @@ namespace ArgusTV
 
   int64_t MultiFileReader::SetFilePointer(int64_t llDistanceToMove, unsigned long dwMoveMethod)
   {
-    RefreshTSBufferFile();
+    // Seeks from the end need the current end position, other seeks only when they go near it
+    int64_t target = (dwMoveMethod == FILE_CURRENT ? m_currentReadPosition : m_startPosition) + llDistanceToMove;
+    RefreshIfNeeded(target, dwMoveMethod == FILE_END);
 
     if (dwMoveMethod == FILE_END)
     {
@@ -207,7 +262,8 @@ namespace ArgusTV
     if (m_TSBufferFile.IsFileInvalid())
       return S_FALSE;
 
-    RefreshTSBufferFile();
+    m_reads++;
+    RefreshIfNeeded(m_currentReadPosition + lDataLength, false);
 
     if (m_currentReadPosition < m_startPosition)
     {
@@ -250,6 +306,14 @@ namespace ArgusTV
         }
       }
 
+      // Near the end of a segment that is complete the next one can be read ahead
+      if (it + 1 < m_tsFiles.end() && (*(it + 1))->filePositionId != m_preparedFileId &&
+        file->startPosition + file->length - m_currentReadPosition < PREPARE_NEXT_DISTANCE)
+      {
+        m_preparedFileId = (*(it + 1))->filePositionId;
+        m_TSFile.PrepareNext((*(it + 1))->filename.c_str());
+      }
+
       int64_t seekPosition = m_currentReadPosition - file->startPosition;
 
       int64_t posSeeked = m_TSFile.GetFilePointer();
@@ -304,11 +368,27 @@ namespace ArgusTV
   }
 
 
+  long MultiFileReader::RefreshIfNeeded(int64_t position, bool bExact)
+  {
+    if (bExact)
+      m_refreshesExact++;
+    else if (position >= 0 && position + REFRESH_DISTANCE > m_endPosition)
+      m_refreshesAtEnd++;
+    else if (P8PLATFORM::GetTimeMs() - m_lastRefresh >= REFRESH_INTERVAL)
+      m_refreshesTimed++;
+    else
+      return S_OK;
+    return RefreshTSBufferFile();
+  }
+
   long MultiFileReader::RefreshTSBufferFile()
   {
     if (m_TSBufferFile.IsFileInvalid())
       return S_FALSE;
 
+    m_refreshes++;
+    m_lastRefresh = P8PLATFORM::GetTimeMs();
+
     unsigned long bytesRead;
     MultiFileReaderFile *file;
 
@@ -614,20 +694,18 @@ namespace ArgusTV
   long MultiFileReader::GetFileLength(const char* pFilename, int64_t &length)
   {
     length = 0;
-    struct __stat64 stat;
-    if (XBMC->StatFile(pFilename, &stat) != 0)
+    if (!CFileBackend::GetFileLength(pFilename, length))
     {
       XBMC->Log(LOG_ERROR, "MultiFileReader::GetFileLength: can not get stat from file %s.", pFilename);
       return S_FALSE;
     }
-
-    length = stat.st_size;
     return S_OK;
   }
 
   int64_t MultiFileReader::GetFileSize()
   {
-    RefreshTSBufferFile();
+    // Kodi asks for the length all the time to show the progress, a length that is REFRESH_INTERVAL old does
+    RefreshIfNeeded(-1, false);
     return m_endPosition - m_startPosition;
   }
 
@@ -34,6 +34,7 @@
  */
 
 #include "FileReader.h"
+#include "DataNotifier.h"
 #include <vector>
 #include <string>
 
@@ -65,10 +66,28 @@ namespace ArgusTV
       virtual int64_t GetFilePointer();
       virtual int64_t GetFileSize();
       virtual void OnZap(void);
+      virtual int64_t GetOpenWaitTime(){ return m_openWaitTime; };
+
+      /**
+       * \brief Wake the waits of OpenFile() for the buffer file when its directory changes. The
+       *        notifier must be opened on the buffer file first; NULL waits by polling.
+       */
+      void SetNotifier(CDataNotifier* notifier) { m_notifier = notifier; }
 
   protected:
       long RefreshTSBufferFile();
+      /**
+       * \brief Read the buffer file again when the known positions may not do: when position (the end
+       *        of what the caller is about to read, -1 when it reads nothing) gets near the end position,
+       *        when bExact is set, or when REFRESH_INTERVAL passed since the last refresh
+       */
+      long RefreshIfNeeded(int64_t position, bool bExact);
       long GetFileLength(const char* pFilename, int64_t &length);
+      /**
+       * \brief Wait for the buffer file to change, at most interval and timeLeft ms; the interval doubles
+       *        up to MAX_BUFFER_POLL_INTERVAL
+       */
+      void WaitForBufferFile(unsigned long& interval, unsigned long timeLeft);
 
       FileReader m_TSBufferFile;
       int64_t m_startPosition;
@@ -77,12 +96,23 @@ namespace ArgusTV
       long m_filesAdded;
       long m_filesRemoved;
       int64_t m_lastZapPosition;
+      int64_t m_openWaitTime;       // ms OpenFile() waited for the buffer file
+      CDataNotifier* m_notifier;    // wakes the waits for the buffer file, may be NULL
 
       std::vector<MultiFileReaderFile *> m_tsFiles;
 
       FileReader m_TSFile;
       long     m_TSFileId;
+      long     m_preparedFileId;     // segment that was handed to m_TSFile.PrepareNext()
       bool     m_bDelay;
+
+      // refresh policy and statistics, logged on close
+      int64_t  m_lastRefresh;        // GetTimeMs() of the last refresh
+      unsigned long m_reads;
+      unsigned long m_refreshes;
+      unsigned long m_refreshesAtEnd;
+      unsigned long m_refreshesExact;
+      unsigned long m_refreshesTimed;
       bool     m_bDebugOutput;
   };
 }
\ No newline at end of file
@@ -0,0 +1,245 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "PrefetchReader.h"
+#include "client.h" //for XBMC->Log
+#include <algorithm> //std::min, std::max
+#include <string.h>
+#include "p8-platform/util/timeutils.h"
+
+using namespace ADDON;
+using namespace P8PLATFORM;
+
+// Ring capacity; the part that is kept filled depends on the bitrate
+#define PREFETCH_CAPACITY   (8 * 1024 * 1024)
+#define PREFETCH_MIN_FILL   (256 * 1024)
+// Seconds of the measured bitrate to keep buffered
+#define PREFETCH_SECONDS    2
+// Largest single read of the producer
+#define PREFETCH_CHUNK      (64 * 1024)
+
+namespace ArgusTV
+{
+  CPrefetchReader::CPrefetchReader(FileReader* reader, CDataNotifier* notifier) :
+    m_reader(reader),
+    m_notifier(notifier),
+    m_ring(PREFETCH_CAPACITY),
+    m_head(0),
+    m_tail(0),
+    m_atEnd(false),
+    m_error(false),
+    m_position(0),
+    m_bytesPerSecond(0),
+    m_rateStart(0),
+    m_rateBytes(0),
+    m_reads(0),
+    m_stalls(0),
+    m_stallMs(0),
+    m_fillSum(0),
+    m_fillMin(PREFETCH_CAPACITY)
+  {
+    XBMC->Log(LOG_DEBUG, "CPrefetchReader:: constructor");
+    m_position = m_reader->GetFilePointer();
+    m_rateStart = GetTimeMs();
+  }
+
+  CPrefetchReader::~CPrefetchReader(void)
+  {
+    XBMC->Log(LOG_DEBUG, "CPrefetchReader:: destructor");
+    StopThread();
+  }
+
+  size_t CPrefetchReader::TargetFill(void) const
+  {
+    size_t target = (size_t) m_bytesPerSecond.load() * PREFETCH_SECONDS;
+    return std::min(std::max(target, (size_t) PREFETCH_MIN_FILL), m_ring.size());
+  }
+
+  void *CPrefetchReader::Process(void)
+  {
+    XBMC->Log(LOG_DEBUG, "CPrefetchReader:: thread started");
+    while (!IsStopped())
+    {
+      uint64_t head = m_head.load(std::memory_order_relaxed);
+      size_t fill = (size_t) (head - m_tail.load(std::memory_order_acquire));
+      size_t target = TargetFill();
+      if (fill >= target || m_error)
+      {
+        m_spaceEvent.Wait(100);
+        continue;
+      }
+
+      // Read into the free space up to the end of the ring, the rest follows in the next round
+      size_t offset = (size_t) (head % m_ring.size());
+      unsigned long wanted = (unsigned long) std::min(std::min(target - fill, (size_t) PREFETCH_CHUNK), m_ring.size() - offset);
+      unsigned long read = 0;
+      bool atEnd;
+      {
+        CLockObject lock(m_readerMutex);
+        // A seek may have discarded the ring in the mean time, it never moves the head
+        if (m_reader->IsFileInvalid())
+        {
+          m_error = true;
+          m_dataEvent.Signal();
+          continue;
+        }
+        m_reader->Read(&m_ring[offset], wanted, &read);
+        m_head.store(head + read, std::memory_order_release);
+        atEnd = (read < wanted);
+        m_atEnd.store(atEnd, std::memory_order_release);
+      }
+
+      if (read > 0 && m_notifier)
+        m_notifier->DataRead(read);
+      m_dataEvent.Signal();
+
+      if (atEnd)
+      {
+        // Live: wait for the timeshift buffer to grow. Recording: wait for a seek or Stop.
+        if (m_notifier)
+          m_notifier->Wait(wanted - read, 100);
+        else
+          m_spaceEvent.Wait(100);
+      }
+    }
+    XBMC->Log(LOG_DEBUG, "CPrefetchReader:: thread stopped");
+    return NULL;
+  }
+
+  long CPrefetchReader::Read(unsigned char* pbData, unsigned long lDataLength, unsigned long *dwReadBytes)
+  {
+    unsigned long done = 0;
+    int64_t stallStart = 0;
+
+    uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    size_t fill = (size_t) (m_head.load(std::memory_order_acquire) - tail);
+    m_reads++;
+    m_fillSum += fill;
+    m_fillMin = std::min(m_fillMin, fill);
+
+    while (done < lDataLength)
+    {
+      tail = m_tail.load(std::memory_order_relaxed);
+      uint64_t head = m_head.load(std::memory_order_acquire);
+      if (head > tail)
+      {
+        size_t offset = (size_t) (tail % m_ring.size());
+        size_t count = (size_t) std::min((uint64_t) (lDataLength - done), head - tail);
+        count = std::min(count, m_ring.size() - offset);
+        memcpy(pbData + done, &m_ring[offset], count);
+        m_tail.store(tail + count, std::memory_order_release);
+        done += (unsigned long) count;
+        m_spaceEvent.Signal();
+        continue;
+      }
+
+      // Empty: give up when the producer is at the end; data it added just before counts
+      if (m_atEnd.load(std::memory_order_acquire) || m_error || !IsRunning())
+      {
+        if (m_head.load(std::memory_order_acquire) > tail)
+          continue;
+        break;
+      }
+
+      if (stallStart == 0)
+      {
+        stallStart = GetTimeMs();
+        m_stalls++;
+      }
+      m_dataEvent.Wait(100);
+    }
+
+    if (stallStart)
+      m_stallMs += GetTimeMs() - stallStart;
+
+    m_position += done;
+    MeasureBitrate(done);
+    *dwReadBytes = done;
+    return (done == 0 && m_error) ? S_FALSE : S_OK;
+  }
+
+  void CPrefetchReader::MeasureBitrate(unsigned long bytes)
+  {
+    m_rateBytes += bytes;
+    int64_t now = GetTimeMs();
+    int64_t elapsed = now - m_rateStart;
+    if (elapsed < 1000)
+      return;
+    uint32_t rate = (uint32_t) (m_rateBytes * 1000 / elapsed);
+    uint32_t previous = m_bytesPerSecond.load();
+    m_bytesPerSecond = (previous == 0) ? rate : (3 * previous + rate) / 4;
+    m_rateStart = now;
+    m_rateBytes = 0;
+  }
+
+  void CPrefetchReader::Discard(void)
+  {
+    // Called with m_readerMutex held, so the producer is not adding data
+    m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+    m_atEnd = false;
+    m_error = false;
+    m_position = m_reader->GetFilePointer();
+    m_spaceEvent.Signal();
+  }
+
+  int64_t CPrefetchReader::SetFilePointer(int64_t llDistanceToMove, unsigned long dwMoveMethod)
+  {
+    CLockObject lock(m_readerMutex);
+    // The reader is ahead of the consumer by the contents of the ring
+    if (dwMoveMethod == FILE_CURRENT)
+      llDistanceToMove -= (int64_t) (m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire));
+    int64_t rc = m_reader->SetFilePointer(llDistanceToMove, dwMoveMethod);
+    Discard();
+    return rc;
+  }
+
+  int64_t CPrefetchReader::GetFilePointer(void)
+  {
+    return m_position;
+  }
+
+  int64_t CPrefetchReader::GetFileSize(void)
+  {
+    CLockObject lock(m_readerMutex);
+    return m_reader->GetFileSize();
+  }
+
+  void CPrefetchReader::OnZap(void)
+  {
+    CLockObject lock(m_readerMutex);
+    m_reader->OnZap();
+    Discard();
+  }
+
+  bool CPrefetchReader::WaitForData(unsigned long maxWaitMs)
+  {
+    if (m_head.load(std::memory_order_acquire) > m_tail.load(std::memory_order_relaxed))
+      return true;
+    return m_dataEvent.Wait(maxWaitMs);
+  }
+
+  void CPrefetchReader::LogStatistics(void)
+  {
+    XBMC->Log(LOG_INFO, "CPrefetchReader: %u reads, %u stalls (%d ms), fill average %d kB minimum %d kB, target %d kB at %d kbit/s.",
+      m_reads, m_stalls, (int) m_stallMs, (int) (m_reads ? m_fillSum / m_reads / 1024 : 0), (int) (m_reads ? m_fillMin / 1024 : 0),
+      (int) (TargetFill() / 1024), (int) (m_bytesPerSecond.load() / 125));
+  }
+}
@@ -0,0 +1,89 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <atomic>
+#include <vector>
+#include "p8-platform/threads/threads.h"
+#include "FileReader.h"
+#include "DataNotifier.h"
+
+namespace ArgusTV
+{
+  /**
+   * \brief Reads ahead from a FileReader on its own thread into a single-producer/single-consumer
+   *        ring buffer, so the player's reads are not stalled by network round-trips.
+   *        The producer keeps about PREFETCH_SECONDS of the measured bitrate buffered. The data
+   *        path is lock-free; seeks and size queries take the reader lock and discard the ring.
+   */
+  class CPrefetchReader : public P8PLATFORM::CThread
+  {
+  public:
+    /**
+     * \param notifier Wakes the producer when a growing file has new data, NULL for recordings
+     */
+    CPrefetchReader(FileReader* reader, CDataNotifier* notifier);
+    virtual ~CPrefetchReader(void);
+
+    long Read(unsigned char* pbData, unsigned long lDataLength, unsigned long *dwReadBytes);
+    int64_t SetFilePointer(int64_t llDistanceToMove, unsigned long dwMoveMethod);
+    int64_t GetFilePointer(void);
+    int64_t GetFileSize(void);
+    void OnZap(void);
+
+    /**
+     * \brief Wait until the producer added data or reached the end, at most maxWaitMs
+     */
+    bool WaitForData(unsigned long maxWaitMs);
+
+    void LogStatistics(void);
+
+  private:
+    virtual void *Process(void);
+    void Discard(void);
+    size_t TargetFill(void) const;
+    void MeasureBitrate(unsigned long bytes);
+
+    FileReader*              m_reader;
+    CDataNotifier*           m_notifier;
+    P8PLATFORM::CMutex       m_readerMutex;  // the producer's reads vs. seeks and size queries
+    P8PLATFORM::CEvent       m_dataEvent;    // producer -> consumer: data added or end reached
+    P8PLATFORM::CEvent       m_spaceEvent;   // consumer -> producer: space freed or ring discarded
+    std::vector<unsigned char> m_ring;
+    std::atomic<uint64_t>    m_head;         // bytes written into the ring, producer only
+    std::atomic<uint64_t>    m_tail;         // bytes taken from the ring, consumer only (and Discard)
+    std::atomic<bool>        m_atEnd;        // the last read reached the end of the (growing) file
+    std::atomic<bool>        m_error;        // the reader failed, e.g. the file was closed
+    std::atomic<int64_t>     m_position;     // the consumer's position in the file
+    std::atomic<uint32_t>    m_bytesPerSecond;
+
+    // bitrate measurement, consumer only
+    int64_t  m_rateStart;
+    uint64_t m_rateBytes;
+
+    // statistics, consumer only
+    unsigned int m_reads;
+    unsigned int m_stalls;
+    int64_t      m_stallMs;
+    uint64_t     m_fillSum;
+    size_t       m_fillMin;
+  };
+}
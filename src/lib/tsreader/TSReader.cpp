@@ -30,25 +30,29 @@
 #include "TSReader.h"
 #include "client.h" //for XBMC->Log
 #include "MultiFileReader.h"
+#include "TsReadyDetector.h"
 #include "utils.h"
 #include "p8-platform/os.h"
+#include "p8-platform/util/timeutils.h"
+#include <vector>
 
 using namespace ADDON;
 
 namespace ArgusTV
 {
   CTsReader::CTsReader() :
-    m_fileReader(NULL),
-    m_bLiveTv(false),
+    m_bTimeShifting(false),
     m_bRecording(false),
-    m_bTimeShifting(false)
+    m_bLiveTv(false),
+    m_fileReader(NULL),
+    m_prefetchReader(NULL)
   {
 #if defined(TARGET_WINDOWS)
     liDelta.QuadPart = liCount.QuadPart = 0;
 #endif
   }
 
-  long CTsReader::Open(const char* pszFileName)
+  long CTsReader::Open(const char* pszFileName, bool bPrefetch)
   {
     XBMC->Log(LOG_DEBUG, "CTsReader::Open(%s)", pszFileName);
 
@@ -65,6 +69,7 @@ namespace ArgusTV
       //local .ts file
       m_bTimeShifting = false;
       m_bLiveTv = false;
+      // Not streaming: a recording can be deleted or cut while it plays, which a mapping does not survive
       m_fileReader = new FileReader();
     }
     else
@@ -75,6 +80,16 @@ namespace ArgusTV
       m_fileReader = new MultiFileReader();
     }
 
+    std::string localname;
+    bool bLocal = ToLocalPath(m_fileName, localname);
+    if (m_bTimeShifting)
+    {
+      // The notifier can watch the local path of a share. It is opened first, so it also wakes
+      // the reader that waits for a new buffer file to be written.
+      m_notifier.Open(bLocal ? localname.c_str() : m_fileName.c_str());
+      static_cast<MultiFileReader*>(m_fileReader)->SetNotifier(&m_notifier);
+    }
+
     //open file
     if (m_fileReader->SetFileName(m_fileName.c_str()) != S_OK)
     {
@@ -87,6 +102,25 @@ namespace ArgusTV
       return S_FALSE;
     }
     m_fileReader->SetFilePointer(0LL, FILE_BEGIN);
+#if !defined(TARGET_WINDOWS)
+    // Local timeshift segments are read ahead by their backend (io_uring or a mapping), a prefetch ring
+    // would only add a copy. Recordings use plain reads and keep the ring.
+    if (bLocal && bPrefetch && m_bTimeShifting)
+    {
+      XBMC->Log(LOG_DEBUG, "CTsReader::Open %s is read ahead locally, not prefetching.", localname.c_str());
+      bPrefetch = false;
+    }
+#endif
+
+    if (bPrefetch)
+    {
+      m_prefetchReader = new CPrefetchReader(m_fileReader, m_bTimeShifting ? &m_notifier : NULL);
+      if (!m_prefetchReader->CreateThread())
+      {
+        XBMC->Log(LOG_ERROR, "CTsReader::Open could not start the prefetch thread, reading directly.");
+        SAFE_DELETE(m_prefetchReader);
+      }
+    }
 
     return S_OK;
   }
@@ -110,7 +144,18 @@ namespace ArgusTV
       liLast = liCurrent;
 #endif
 
-      long rc = m_fileReader->Read(pbData, lDataLength, dwReadBytes);
+      long rc;
+      if (m_prefetchReader)
+      {
+        // the prefetch thread accounts the data for the notifier
+        rc = m_prefetchReader->Read(pbData, lDataLength, dwReadBytes);
+      }
+      else
+      {
+        rc = m_fileReader->Read(pbData, lDataLength, dwReadBytes);
+        if (m_bTimeShifting)
+          m_notifier.DataRead(*dwReadBytes);
+      }
 
 #if defined(TARGET_WINDOWS)
       if (!QueryPerformanceCounter(&liCurrent))
@@ -129,31 +174,109 @@ namespace ArgusTV
 
   void CTsReader::Close()
   {
+    if (m_prefetchReader)
+    {
+      m_prefetchReader->StopThread();
+      m_prefetchReader->LogStatistics();
+      SAFE_DELETE(m_prefetchReader);
+    }
     if (m_fileReader)
     {
       m_fileReader->CloseFile();
       SAFE_DELETE(m_fileReader);
     }
+    if (m_bTimeShifting)
+    {
+      m_notifier.LogStatistics();
+      m_notifier.Close();
+    }
   }
 
   int64_t CTsReader::SetFilePointer(int64_t llDistanceToMove, unsigned long dwMoveMethod)
   {
+    if (m_prefetchReader)
+      return m_prefetchReader->SetFilePointer(llDistanceToMove, dwMoveMethod);
     return m_fileReader->SetFilePointer(llDistanceToMove, dwMoveMethod);
   }
 
   int64_t CTsReader::GetFileSize()
   {
+    if (m_prefetchReader)
+      return m_prefetchReader->GetFileSize();
     return m_fileReader->GetFileSize();
   }
 
+  int64_t CTsReader::GetOpenWaitTime(void)
+  {
+    return m_fileReader ? m_fileReader->GetOpenWaitTime() : 0;
+  }
+
   int64_t CTsReader::GetFilePointer()
   {
+    if (m_prefetchReader)
+      return m_prefetchReader->GetFilePointer();
     return m_fileReader->GetFilePointer();
   }
 
   void CTsReader::OnZap(void)
   {
-    m_fileReader->OnZap();
+    if (m_prefetchReader)
+      m_prefetchReader->OnZap();
+    else
+      m_fileReader->OnZap();
+  }
+
+  bool CTsReader::WaitForData(unsigned long bytesNeeded, unsigned long maxWaitMs)
+  {
+    if (m_prefetchReader)
+      return m_prefetchReader->WaitForData(maxWaitMs);
+    return m_notifier.Wait(bytesNeeded, maxWaitMs);
+  }
+
+  void CTsReader::Underrun(int64_t durationMs, bool stalled)
+  {
+    m_notifier.Underrun(durationMs, stalled);
+  }
+
+// Most data that is scanned for the start of a decodable stream
+#define READY_SCAN_LIMIT (8 * 1024 * 1024)
+#define READY_SCAN_CHUNK (64 * 1024)
+
+  bool CTsReader::WaitUntilReady(unsigned long timeoutMs)
+  {
+    if (!m_fileReader)
+      return false;
+
+    CTsReadyDetector detector;
+    std::vector<unsigned char> buffer(READY_SCAN_CHUNK);
+    P8PLATFORM::CTimeout timeout(timeoutMs);
+    int64_t scanned = 0;
+    bool ready = false;
+
+    while (!ready && scanned < READY_SCAN_LIMIT)
+    {
+      unsigned long read = 0;
+      if (Read(&buffer[0], (unsigned long) buffer.size(), &read) != S_OK && read == 0 && m_fileReader->IsFileInvalid())
+        break;
+      if (read > 0)
+      {
+        scanned += read;
+        ready = detector.Feed(&buffer[0], read);
+        continue;
+      }
+      unsigned long left = timeout.TimeLeft();
+      if (left == 0)
+        break;
+      WaitForData(READY_SCAN_CHUNK, left);
+    }
+
+    XBMC->Log(LOG_DEBUG, "CTsReader::WaitUntilReady %s after %lld bytes (PAT %d, PMT %d, keyframe %d).", ready ? "ready" : "gave up",
+      (long long) scanned, detector.HasPat(), detector.HasPmt(), detector.HasKeyframe());
+
+    // The player starts where the scan started
+    if (scanned > 0)
+      SetFilePointer(-scanned, FILE_CURRENT);
+    return ready;
   }
 
 #if defined(TARGET_WINDOWS)
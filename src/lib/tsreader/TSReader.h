@@ -30,6 +30,8 @@
 
 #include "client.h"
 #include "FileReader.h"
+#include "DataNotifier.h"
+#include "PrefetchReader.h"
 #include "p8-platform/util/StdString.h"
 
 namespace ArgusTV
@@ -39,13 +41,38 @@ namespace ArgusTV
   public:
     CTsReader();
     ~CTsReader(void) {};
-    long Open(const char* pszFileName);
+    /**
+     * \param bPrefetch read ahead on a separate thread
+     */
+    long Open(const char* pszFileName, bool bPrefetch = false);
     long Read(unsigned char* pbData, unsigned long lDataLength, unsigned long *dwReadBytes);
     void Close();
     int64_t SetFilePointer(int64_t llDistanceToMove, unsigned long dwMoveMethod);
     int64_t GetFileSize();
     int64_t GetFilePointer();
     void OnZap(void);
+
+    /**
+     * \brief Wait until about bytesNeeded more bytes can be read from a growing file, at most maxWaitMs
+     */
+    bool WaitForData(unsigned long bytesNeeded, unsigned long maxWaitMs);
+
+    /**
+     * \brief Account a read that had to wait for data, reported when the reader is closed
+     */
+    void Underrun(int64_t durationMs, bool stalled);
+
+    /**
+     * \brief Wait until the stream from the current position on can be decoded (PAT, PMT and a
+     *        video keyframe), at most timeoutMs. The read position is left unchanged.
+     * \return true when the stream is ready
+     */
+    bool WaitUntilReady(unsigned long timeoutMs);
+
+    /**
+     * \brief Milliseconds Open() spent waiting for the timeshift buffer file to become usable
+     */
+    int64_t GetOpenWaitTime(void);
 #if defined(TARGET_WINDOWS)
     long long sigmaTime();
     long long  sigmaCount();
@@ -57,6 +84,8 @@ namespace ArgusTV
     bool            m_bLiveTv;
     CStdString      m_fileName;
     FileReader*     m_fileReader;
+    CPrefetchReader* m_prefetchReader;
+    CDataNotifier   m_notifier;
 #if defined(TARGET_WINDOWS)
     LARGE_INTEGER   liDelta;
     LARGE_INTEGER   liCount;
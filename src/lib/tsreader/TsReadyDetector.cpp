@@ -0,0 +1,211 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "TsReadyDetector.h"
+#include <string.h>
+
+#define TS_PACKET_SIZE 188
+#define TS_SYNC_BYTE   0x47
+
+namespace ArgusTV
+{
+  CTsReadyDetector::CTsReadyDetector(void) :
+    m_pmtPid(-1),
+    m_bPmt(false),
+    m_videoPid(-1),
+    m_videoType(0),
+    m_bKeyframe(false)
+  {
+  }
+
+  bool CTsReadyDetector::IsReady(void) const
+  {
+    return m_bPmt && (m_videoPid < 0 || m_bKeyframe);
+  }
+
+  bool CTsReadyDetector::Feed(const unsigned char* data, size_t length)
+  {
+    // Continue with the data that was left over by the previous call
+    if (!m_pending.empty())
+    {
+      m_pending.insert(m_pending.end(), data, data + length);
+      data = &m_pending[0];
+      length = m_pending.size();
+    }
+
+    while (length >= TS_PACKET_SIZE && !IsReady())
+    {
+      // Resynchronise on a sync byte that is followed by another one
+      if (data[0] != TS_SYNC_BYTE || (length >= 2 * TS_PACKET_SIZE && data[TS_PACKET_SIZE] != TS_SYNC_BYTE))
+      {
+        data++;
+        length--;
+        continue;
+      }
+      Packet(data);
+      data += TS_PACKET_SIZE;
+      length -= TS_PACKET_SIZE;
+    }
+
+    // Keep the incomplete packet at the end (this may alias m_pending)
+    std::vector<unsigned char> rest;
+    if (!IsReady())
+      rest.assign(data, data + length);
+    m_pending.swap(rest);
+    return IsReady();
+  }
+
+  void CTsReadyDetector::Packet(const unsigned char* packet)
+  {
+    int pid = ((packet[1] & 0x1F) << 8) | packet[2];
+    bool unitStart = (packet[1] & 0x40) != 0;
+    int adaptation = (packet[3] >> 4) & 0x03;
+
+    size_t offset = 4;
+    bool randomAccess = false;
+    if (adaptation & 0x02)
+    {
+      size_t adaptationLength = packet[4];
+      if (adaptationLength > 0)
+        randomAccess = (packet[5] & 0x40) != 0;
+      offset += 1 + adaptationLength;
+    }
+    if (!(adaptation & 0x01) || offset >= TS_PACKET_SIZE)
+    {
+      if (pid == m_videoPid && randomAccess)
+        m_bKeyframe = true;
+      return;
+    }
+
+    const unsigned char* payload = packet + offset;
+    size_t payloadLength = TS_PACKET_SIZE - offset;
+
+    if ((pid == 0 && m_pmtPid < 0) || (pid == m_pmtPid && !m_bPmt))
+    {
+      if (!unitStart)
+        return;
+      size_t pointer = payload[0];
+      if (1 + pointer >= payloadLength)
+        return;
+      if (pid == 0)
+        ParsePat(payload + 1 + pointer, payloadLength - 1 - pointer);
+      else
+        ParsePmt(payload + 1 + pointer, payloadLength - 1 - pointer);
+    }
+    else if (pid == m_videoPid && m_bPmt && !m_bKeyframe)
+    {
+      if (randomAccess || (unitStart && IsKeyframe(payload, payloadLength)))
+        m_bKeyframe = true;
+    }
+  }
+
+  void CTsReadyDetector::ParsePat(const unsigned char* section, size_t length)
+  {
+    if (length < 8 || section[0] != 0x00)
+      return;
+    size_t sectionLength = ((section[1] & 0x0F) << 8) | section[2];
+    size_t end = 3 + sectionLength;
+    if (end > length || sectionLength < 9)
+      return;
+    end -= 4; // CRC
+
+    for (size_t i = 8; i + 4 <= end; i += 4)
+    {
+      int program = (section[i] << 8) | section[i + 1];
+      if (program != 0) // 0 is the network PID
+      {
+        m_pmtPid = ((section[i + 2] & 0x1F) << 8) | section[i + 3];
+        return;
+      }
+    }
+  }
+
+  void CTsReadyDetector::ParsePmt(const unsigned char* section, size_t length)
+  {
+    if (length < 12 || section[0] != 0x02)
+      return;
+    size_t sectionLength = ((section[1] & 0x0F) << 8) | section[2];
+    size_t end = 3 + sectionLength;
+    if (end > length || sectionLength < 13)
+      return;
+    end -= 4; // CRC
+
+    size_t programInfoLength = ((section[10] & 0x0F) << 8) | section[11];
+    for (size_t i = 12 + programInfoLength; i + 5 <= end; )
+    {
+      uint8_t streamType = section[i];
+      int pid = ((section[i + 1] & 0x1F) << 8) | section[i + 2];
+      size_t infoLength = ((section[i + 3] & 0x0F) << 8) | section[i + 4];
+      if (m_videoPid < 0 && (streamType == 0x01 || streamType == 0x02 || streamType == 0x10 || streamType == 0x1B || streamType == 0x24))
+      {
+        m_videoPid = pid;
+        m_videoType = streamType;
+      }
+      i += 5 + infoLength;
+    }
+    m_bPmt = true;
+  }
+
+  bool CTsReadyDetector::IsKeyframe(const unsigned char* payload, size_t length) const
+  {
+    // PES header: 00 00 01 stream_id length(2) flags(2) header_data_length
+    if (length < 9 || payload[0] != 0 || payload[1] != 0 || payload[2] != 1)
+      return false;
+    size_t offset = 9 + payload[8];
+
+    // Look for the first picture in the rest of this packet
+    for (size_t i = offset; i + 5 < length; i++)
+    {
+      if (payload[i] != 0 || payload[i + 1] != 0 || payload[i + 2] != 1)
+        continue;
+      unsigned char code = payload[i + 3];
+      switch (m_videoType)
+      {
+        case 0x01:
+        case 0x02:
+          if (code == 0x00) // picture start code, picture_coding_type 1 is an I-picture
+            return ((payload[i + 5] >> 3) & 0x07) == 1;
+          break;
+        case 0x1B:
+        {
+          int type = code & 0x1F;
+          if (type == 5)
+            return true;
+          if (type == 1)
+            return false;
+          break;
+        }
+        case 0x24:
+        {
+          int type = (code >> 1) & 0x3F;
+          if (type >= 16 && type <= 21)
+            return true;
+          if (type < 16)
+            return false;
+          break;
+        }
+        default:
+          break;
+      }
+    }
+    return false;
+  }
+}
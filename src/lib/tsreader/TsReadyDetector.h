@@ -0,0 +1,64 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+namespace ArgusTV
+{
+  /**
+   * \brief Scans the start of a transport stream until a player can start decoding it:
+   *        a PAT, the PMT of its first program and, when that program has video, a keyframe
+   *        (random access indicator, MPEG-2 I-picture, H.264 IDR or HEVC IRAP picture).
+   *        Sections are expected to fit in one packet, which holds for PAT and PMT in practice.
+   */
+  class CTsReadyDetector
+  {
+  public:
+    CTsReadyDetector(void);
+
+    /**
+     * \brief Scan the next part of the stream
+     * \return true when the stream is ready
+     */
+    bool Feed(const unsigned char* data, size_t length);
+
+    bool IsReady(void) const;
+    bool HasPat(void) const { return m_pmtPid >= 0; }
+    bool HasPmt(void) const { return m_bPmt; }
+    bool HasKeyframe(void) const { return m_bKeyframe; }
+
+  private:
+    void Packet(const unsigned char* packet);
+    void ParsePat(const unsigned char* section, size_t length);
+    void ParsePmt(const unsigned char* section, size_t length);
+    bool IsKeyframe(const unsigned char* payload, size_t length) const;
+
+    std::vector<unsigned char> m_pending; // the start of a packet that continues in the next Feed()
+    int     m_pmtPid;             // -1 until the PAT was seen
+    bool    m_bPmt;
+    int     m_videoPid;           // -1 when the program has no video
+    uint8_t m_videoType;          // stream_type of the video stream
+    bool    m_bKeyframe;
+  };
+}
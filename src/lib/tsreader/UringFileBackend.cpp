@@ -0,0 +1,508 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "UringFileBackend.h"
+
+#if defined(HAVE_IO_URING)
+#include "client.h" //for XBMC->Log
+#include <algorithm> //std::min
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace ADDON;
+
+namespace ArgusTV
+{
+  // Size of one block read
+#define URING_BLOCK_SIZE (512 * 1024)
+  // Block reads kept in flight ahead of the reader
+#define URING_DEPTH 4
+  // Blocks read at the start of the next segment
+#define URING_NEXT_BLOCKS 2
+#define URING_BLOCKS (URING_DEPTH + URING_NEXT_BLOCKS)
+  // Submission queue size, a power of two >= URING_BLOCKS
+#define URING_ENTRIES 8
+
+  // Set when the kernel (or a container) refuses io_uring, so it is not tried for every file
+  static bool g_bUringUnavailable = false;
+
+  static int io_uring_setup(unsigned entries, struct io_uring_params* params)
+  {
+    return (int) syscall(__NR_io_uring_setup, entries, params);
+  }
+
+  static int io_uring_enter(int ring, unsigned toSubmit, unsigned minComplete, unsigned flags)
+  {
+    return (int) syscall(__NR_io_uring_enter, ring, toSubmit, minComplete, flags, NULL, 0);
+  }
+
+  CUringFileBackend::CUringFileBackend(void) :
+    m_fd(-1),
+    m_position(0),
+    m_nextFd(-1),
+    m_bFailed(false),
+    m_ring(-1),
+    m_sqRing(NULL),
+    m_sqRingSize(0),
+    m_cqRing(NULL),
+    m_cqRingSize(0),
+    m_sqes(NULL),
+    m_sqesSize(0),
+    m_sqTail(NULL),
+    m_sqMask(NULL),
+    m_sqArray(NULL),
+    m_cqHead(NULL),
+    m_cqTail(NULL),
+    m_cqMask(NULL),
+    m_cqes(NULL),
+    m_toSubmit(0),
+    m_sqeFlags(0),
+    m_blocks(NULL),
+    m_head(0),
+    m_count(0),
+    m_reads(0),
+    m_blockReads(0),
+    m_waits(0)
+  {
+  }
+
+  CUringFileBackend::~CUringFileBackend(void)
+  {
+    Close();
+  }
+
+  bool CUringFileBackend::SetupRing(void)
+  {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    m_ring = io_uring_setup(URING_ENTRIES, &params);
+    if (m_ring < 0)
+    {
+      XBMC->Log(LOG_NOTICE, "CUringFileBackend: io_uring is not available (error %d: %s), using blocking reads.", errno, strerror(errno));
+      g_bUringUnavailable = true;
+      return false;
+    }
+
+    m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    // Both rings share one mapping since 5.4; older headers do not know the flag
+    bool bSingleMmap = false;
+#if defined(IORING_FEAT_SINGLE_MMAP)
+    bSingleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+#endif
+    if (bSingleMmap)
+      m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+    m_sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    m_sqRing = mmap(NULL, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQ_RING);
+    if (m_sqRing == MAP_FAILED)
+      m_sqRing = NULL;
+    else if (bSingleMmap)
+      m_cqRing = m_sqRing;
+    else
+    {
+      m_cqRing = mmap(NULL, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_CQ_RING);
+      if (m_cqRing == MAP_FAILED)
+        m_cqRing = NULL;
+    }
+    void* sqes = mmap(NULL, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQES);
+    m_sqes = sqes == MAP_FAILED ? NULL : (struct io_uring_sqe*) sqes;
+    if (!m_sqRing || !m_cqRing || !m_sqes)
+    {
+      XBMC->Log(LOG_ERROR, "CUringFileBackend: can not map the io_uring queues.");
+      DestroyRing();
+      return false;
+    }
+
+    unsigned char* sq = (unsigned char*) m_sqRing;
+    unsigned char* cq = (unsigned char*) m_cqRing;
+    m_sqTail = (unsigned*) (sq + params.sq_off.tail);
+    m_sqMask = (unsigned*) (sq + params.sq_off.ring_mask);
+    m_sqArray = (unsigned*) (sq + params.sq_off.array);
+    m_cqHead = (unsigned*) (cq + params.cq_off.head);
+    m_cqTail = (unsigned*) (cq + params.cq_off.tail);
+    m_cqMask = (unsigned*) (cq + params.cq_off.ring_mask);
+    m_cqes = (struct io_uring_cqe*) (cq + params.cq_off.cqes);
+    m_toSubmit = 0;
+
+    // Without IOSQE_ASYNC the kernel tries a read inline first, and on file systems that can not
+    // do that without blocking (FUSE, some network file systems) the submitting thread waits for
+    // every block in turn. The flag came with 5.6, as did IORING_FEAT_RW_CUR_POS.
+    m_sqeFlags = 0;
+#if defined(IORING_FEAT_RW_CUR_POS)
+    if (params.features & IORING_FEAT_RW_CUR_POS)
+      m_sqeFlags = IOSQE_ASYNC;
+#endif
+    return true;
+  }
+
+  void CUringFileBackend::DestroyRing(void)
+  {
+    if (m_sqes)
+      munmap(m_sqes, m_sqesSize);
+    if (m_cqRing && m_cqRing != m_sqRing)
+      munmap(m_cqRing, m_cqRingSize);
+    if (m_sqRing)
+      munmap(m_sqRing, m_sqRingSize);
+    m_sqes = NULL;
+    m_cqRing = m_sqRing = NULL;
+    if (m_ring >= 0)
+      close(m_ring);
+    m_ring = -1;
+  }
+
+  bool CUringFileBackend::Open(const char* pszFileName)
+  {
+    Close();
+    if (g_bUringUnavailable)
+      return false;
+
+    m_fd = open(pszFileName, O_RDONLY | O_CLOEXEC);
+    if (m_fd < 0)
+    {
+      XBMC->Log(LOG_DEBUG, "CUringFileBackend: open %s failed (error %d: %s).", pszFileName, errno, strerror(errno));
+      return false;
+    }
+    if (!SetupRing())
+    {
+      close(m_fd);
+      m_fd = -1;
+      return false;
+    }
+
+    m_blocks = new Block[URING_BLOCKS];
+    for (int i = 0; i < URING_BLOCKS; i++)
+    {
+      void* data = NULL;
+      if (posix_memalign(&data, 4096, URING_BLOCK_SIZE) != 0)
+        data = NULL;
+      m_blocks[i].data = (unsigned char*) data;
+      m_blocks[i].start = 0;
+      m_blocks[i].filled = 0;
+      m_blocks[i].result = 0;
+      m_blocks[i].pending = false;
+      if (!data)
+        m_bFailed = true;
+    }
+    m_position = 0;
+    m_head = m_count = 0;
+    m_reads = m_blockReads = m_waits = 0;
+    if (m_bFailed)
+      Fail("out of memory");
+    XBMC->Log(LOG_DEBUG, "CUringFileBackend: reading %s.", pszFileName);
+    return true;
+  }
+
+  void CUringFileBackend::Close(void)
+  {
+    if (m_fd < 0)
+      return;
+
+    // The kernel may still write into the blocks, they can only be freed when all reads completed
+    bool bIdle = m_bFailed ? true : Drain();
+    for (int i = 0; i < URING_BLOCKS; i++)
+    {
+      if (m_blocks[i].pending)
+        bIdle = false;
+    }
+    DestroyRing();
+    if (bIdle)
+    {
+      for (int i = 0; i < URING_BLOCKS; i++)
+        free(m_blocks[i].data);
+      delete[] m_blocks;
+    }
+    else
+      XBMC->Log(LOG_ERROR, "CUringFileBackend: reads did not complete, not freeing their buffers.");
+    m_blocks = NULL;
+
+    if (m_nextFd >= 0)
+      close(m_nextFd);
+    m_nextFd = -1;
+    close(m_fd);
+    m_fd = -1;
+    m_bFailed = false;
+    XBMC->Log(LOG_DEBUG, "CUringFileBackend: %lu reads, %lu block reads, waited %lu times.", m_reads, m_blockReads, m_waits);
+  }
+
+  void CUringFileBackend::Submit(Block& block, int fd)
+  {
+    unsigned tail = *m_sqTail;
+    unsigned index = tail & *m_sqMask;
+    struct io_uring_sqe* sqe = &m_sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    block.iov.iov_base = block.data + block.filled;
+    block.iov.iov_len = URING_BLOCK_SIZE - block.filled;
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = fd;
+    sqe->flags = m_sqeFlags;
+    sqe->addr = (uint64_t) (uintptr_t) &block.iov;
+    sqe->len = 1;
+    sqe->off = block.start + block.filled;
+    sqe->user_data = (uint64_t) (uintptr_t) &block;
+    m_sqArray[index] = index;
+    __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+    block.pending = true;
+    m_toSubmit++;
+    m_blockReads++;
+  }
+
+  bool CUringFileBackend::Flush(void)
+  {
+    while (m_toSubmit > 0)
+    {
+      int submitted = io_uring_enter(m_ring, m_toSubmit, 0, 0);
+      if (submitted < 0)
+      {
+        if (errno == EINTR || errno == EAGAIN)
+          continue;
+        return false;
+      }
+      m_toSubmit -= submitted;
+    }
+    return true;
+  }
+
+  bool CUringFileBackend::Reap(bool bWait)
+  {
+    unsigned head = *m_cqHead;
+    while (bWait && head == __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE))
+    {
+      m_waits++;
+      if (io_uring_enter(m_ring, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+        return false;
+    }
+
+    while (head != __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE))
+    {
+      struct io_uring_cqe* cqe = &m_cqes[head & *m_cqMask];
+      Block* block = (Block*) (uintptr_t) cqe->user_data;
+      block->pending = false;
+      block->result = cqe->res;
+      if (cqe->res > 0)
+        block->filled += cqe->res;
+      head++;
+      __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+    }
+    return true;
+  }
+
+  bool CUringFileBackend::WaitFor(Block& block)
+  {
+    while (block.pending)
+    {
+      if (!Reap(true))
+        return false;
+    }
+    return true;
+  }
+
+  bool CUringFileBackend::Drain(void)
+  {
+    for (int i = 0; i < URING_BLOCKS; i++)
+    {
+      if (!WaitFor(m_blocks[i]))
+        return false;
+    }
+    return true;
+  }
+
+  void CUringFileBackend::Pop(void)
+  {
+    m_head = (m_head + 1) % URING_DEPTH;
+    m_count--;
+  }
+
+  bool CUringFileBackend::Fill(void)
+  {
+    int64_t next = m_count > 0 ? m_blocks[(m_head + m_count - 1) % URING_DEPTH].start + URING_BLOCK_SIZE : m_position;
+    while (m_count < URING_DEPTH)
+    {
+      // A block that was dropped by a seek can still have a read in flight
+      Block& block = m_blocks[(m_head + m_count) % URING_DEPTH];
+      if (!WaitFor(block))
+        return false;
+      block.start = next;
+      block.filled = 0;
+      block.result = 0;
+      Submit(block, m_fd);
+      m_count++;
+      next += URING_BLOCK_SIZE;
+    }
+    return Flush();
+  }
+
+  void CUringFileBackend::Fail(const char* pszWhat)
+  {
+    XBMC->Log(LOG_ERROR, "CUringFileBackend: %s (error %d: %s), continuing with blocking reads.", pszWhat, errno, strerror(errno));
+    m_bFailed = true;
+    m_count = 0;
+  }
+
+  unsigned long CUringFileBackend::ReadBlocking(unsigned char* pbData, unsigned long lDataLength)
+  {
+    unsigned long done = 0;
+    while (done < lDataLength)
+    {
+      ssize_t count = pread(m_fd, pbData + done, lDataLength - done, (off_t) m_position);
+      if (count < 0 && errno == EINTR)
+        continue;
+      if (count <= 0)
+        break;
+      done += count;
+      m_position += count;
+    }
+    return done;
+  }
+
+  unsigned long CUringFileBackend::Read(unsigned char* pbData, unsigned long lDataLength)
+  {
+    if (m_fd < 0)
+      return 0;
+    m_reads++;
+
+    unsigned long done = 0;
+    bool bReread = false;
+    while (done < lDataLength)
+    {
+      if (m_bFailed)
+        return done + ReadBlocking(pbData + done, lDataLength - done);
+
+      if (!Fill())
+      {
+        Fail("submitting reads failed");
+        continue;
+      }
+      Block& block = Front();
+      if (!WaitFor(block))
+      {
+        Fail("waiting for a read failed");
+        continue;
+      }
+      if (block.result < 0 && block.result != -EINTR && block.result != -EAGAIN)
+      {
+        XBMC->Log(LOG_ERROR, "CUringFileBackend: read at %lld failed (error %ld: %s).", (long long) (block.start + block.filled), -block.result, strerror(-block.result));
+        block.result = 0;
+        break;
+      }
+
+      int64_t end = block.start + block.filled;
+      if (m_position < end)
+      {
+        unsigned long count = (unsigned long) std::min((int64_t) (lDataLength - done), end - m_position);
+        memcpy(pbData + done, block.data + (m_position - block.start), count);
+        done += count;
+        m_position += count;
+        bReread = false;
+        continue;
+      }
+      if (block.filled == URING_BLOCK_SIZE)
+      {
+        Pop();
+        continue;
+      }
+
+      // The file ended inside this block when it was read; read the rest again, it may have grown
+      if (bReread)
+        break;
+      Submit(block, m_fd);
+      if (!Flush())
+        Fail("submitting a read failed");
+      bReread = true;
+    }
+    return done;
+  }
+
+  int64_t CUringFileBackend::Seek(int64_t llDistanceToMove, unsigned long dwMoveMethod)
+  {
+    int64_t position;
+    if (dwMoveMethod == FILE_END)
+      position = GetLength() + llDistanceToMove;
+    else if (dwMoveMethod == FILE_CURRENT)
+      position = m_position + llDistanceToMove;
+    else
+      position = llDistanceToMove;
+    if (position < 0)
+      return -1;
+
+    // Keep the read-ahead from the block that holds the new position on
+    if (m_count > 0 && position < Front().start)
+      m_count = 0;
+    while (m_count > 0 && position >= Front().start + URING_BLOCK_SIZE)
+      Pop();
+    m_position = position;
+    return m_position;
+  }
+
+  int64_t CUringFileBackend::GetPosition(void)
+  {
+    return m_position;
+  }
+
+  int64_t CUringFileBackend::GetLength(void)
+  {
+    struct stat st;
+    if (m_fd < 0 || fstat(m_fd, &st) != 0)
+      return -1;
+    return st.st_size;
+  }
+
+  void CUringFileBackend::PrepareNext(const char* pszFileName)
+  {
+    if (m_fd < 0 || m_bFailed)
+      return;
+
+    for (int i = URING_DEPTH; i < URING_BLOCKS; i++)
+    {
+      if (!WaitFor(m_blocks[i]))
+      {
+        Fail("waiting for a read failed");
+        return;
+      }
+    }
+    if (m_nextFd >= 0)
+      close(m_nextFd);
+    m_nextFd = open(pszFileName, O_RDONLY | O_CLOEXEC);
+    if (m_nextFd < 0)
+      return;
+
+    // The data is not kept, reading it puts it in the page cache for the reader of the next segment
+    for (int i = URING_DEPTH; i < URING_BLOCKS; i++)
+    {
+      m_blocks[i].start = (int64_t) (i - URING_DEPTH) * URING_BLOCK_SIZE;
+      m_blocks[i].filled = 0;
+      Submit(m_blocks[i], m_nextFd);
+    }
+    if (!Flush())
+      Fail("submitting reads failed");
+    else
+      XBMC->Log(LOG_DEBUG, "CUringFileBackend: reading ahead in %s.", pszFileName);
+  }
+}
+#endif
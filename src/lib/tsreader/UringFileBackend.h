@@ -0,0 +1,121 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#if defined(TARGET_LINUX) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define HAVE_IO_URING
+#endif
+#endif
+
+#if defined(HAVE_IO_URING)
+#include <sys/uio.h>
+#include "FileBackend.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace ArgusTV
+{
+  /**
+   * \brief Reads a local file front to back with io_uring, keeping URING_DEPTH block reads in
+   *        flight ahead of the reader. A slow read of one block no longer stalls the reads behind
+   *        it, and reads from Kodi are copied out of completed blocks. A block that was read at
+   *        the end of a growing file is read again when the reader gets to it.
+   *        PrepareNext() reads the first blocks of the next timeshift segment in the background,
+   *        so they are cached when the reader switches to it.
+   *        When io_uring can not be set up Open() fails and the caller uses another backend; when
+   *        the ring breaks later the backend continues with blocking reads.
+   */
+  class CUringFileBackend : public CFileBackend
+  {
+  public:
+    CUringFileBackend(void);
+    virtual ~CUringFileBackend(void);
+
+    virtual bool Open(const char* pszFileName);
+    virtual void Close(void);
+    virtual unsigned long Read(unsigned char* pbData, unsigned long lDataLength);
+    virtual int64_t Seek(int64_t llDistanceToMove, unsigned long dwMoveMethod);
+    virtual int64_t GetPosition(void);
+    virtual int64_t GetLength(void);
+    virtual void PrepareNext(const char* pszFileName);
+
+  private:
+    struct Block
+    {
+      unsigned char* data;    // URING_BLOCK_SIZE bytes
+      struct iovec   iov;
+      int64_t        start;   // file position of data[0]
+      unsigned long  filled;  // valid bytes in data
+      long           result;  // of the last read, -errno on an error
+      bool           pending; // a read is in flight
+    };
+
+    bool SetupRing(void);
+    void DestroyRing(void);
+    void Submit(Block& block, int fd);
+    bool Flush(void);
+    bool Reap(bool bWait);
+    bool WaitFor(Block& block);
+    bool Drain(void);
+    bool Fill(void);
+    void Fail(const char* pszWhat);
+    unsigned long ReadBlocking(unsigned char* pbData, unsigned long lDataLength);
+    Block& Front(void) { return m_blocks[m_head]; }
+    void Pop(void);
+
+    int      m_fd;
+    int64_t  m_position;
+    int      m_nextFd;     // next timeshift segment, -1 when none is being prepared
+    bool     m_bFailed;    // the ring broke, reading with pread()
+
+    // the ring, see io_uring_setup(2)
+    int      m_ring;
+    void*    m_sqRing;
+    size_t   m_sqRingSize;
+    void*    m_cqRing;
+    size_t   m_cqRingSize;
+    struct io_uring_sqe* m_sqes;
+    size_t   m_sqesSize;
+    unsigned* m_sqTail;
+    unsigned* m_sqMask;
+    unsigned* m_sqArray;
+    unsigned* m_cqHead;
+    unsigned* m_cqTail;
+    unsigned* m_cqMask;
+    struct io_uring_cqe* m_cqes;
+    unsigned m_toSubmit;
+    unsigned char m_sqeFlags;
+
+    // m_blocks[0..URING_DEPTH) is a circular read-ahead queue starting at m_head,
+    // the remaining blocks are for the next segment
+    Block*   m_blocks;
+    unsigned m_head;
+    unsigned m_count;
+
+    // statistics, logged on close
+    unsigned long m_reads;
+    unsigned long m_blockReads;
+    unsigned long m_waits;
+  };
+}
+#endif
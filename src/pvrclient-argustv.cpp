@@ -18,6 +18,8 @@
  *
  */
 
+#include <map>
+
 #include "client.h"
 //#include "timers.h"
 #include "channel.h"
@@ -29,6 +31,7 @@
 #include "utils.h"
 #include "pvrclient-argustv.h"
 #include "argustvrpc.h"
+#include "JobPool.h"
 #include "p8-platform/util/timeutils.h"
 #include "p8-platform/util/StdString.h"
 
@@ -40,8 +43,120 @@ using namespace ADDON;
 using namespace P8PLATFORM;
 using namespace ArgusTV;
 
-#define SIGNALQUALITY_INTERVAL 10
 #define MAXLIFETIME 99 //Based on VDR addon and VDR documentation. 99=Keep forever, 0=can be deleted at any time, 1..98=days to keep
+#define CONVERT_THREADS 4 //Threads that fill the EPG and recording structs for Kodi, shared by all requests
+
+/**
+ * \brief Fills EPG_TAGs for the programs of one channel on the job pool, transfers them in order.
+ *        The tags point into the cEpg objects, which outlive the conversion.
+ */
+class CEpgConverter : public CParallelConverter<cEpg, EPG_TAG>
+{
+public:
+  CEpgConverter(CJobPool& pool, ADDON_HANDLE handle, unsigned int channeluid, int idoffset) :
+    CParallelConverter<cEpg, EPG_TAG>(pool), m_handle(handle), m_channeluid(channeluid), m_idoffset(idoffset) {}
+
+protected:
+  virtual void Convert(cEpg& epg, EPG_TAG& broadcast, size_t index)
+  {
+    memset(&broadcast, 0, sizeof(EPG_TAG));
+    broadcast.iUniqueBroadcastId  = m_idoffset + (int) index + 1;
+    broadcast.strTitle            = epg.Title();
+    broadcast.iChannelNumber      = m_channeluid;
+    broadcast.startTime           = epg.StartTime();
+    broadcast.endTime             = epg.EndTime();
+    broadcast.strPlotOutline      = epg.Subtitle();
+    broadcast.strPlot             = epg.Description();
+    broadcast.strIconPath         = "";
+    broadcast.iGenreType          = EPG_GENRE_USE_STRING;
+    broadcast.iGenreSubType       = 0;
+    broadcast.strGenreDescription = epg.Genre();
+    broadcast.firstAired          = 0;
+    broadcast.iParentalRating     = 0;
+    broadcast.iStarRating         = 0;
+    broadcast.bNotify             = false;
+    broadcast.iSeriesNumber       = 0;
+    broadcast.iEpisodeNumber      = 0;
+    broadcast.iEpisodePartNumber  = 0;
+    broadcast.strEpisodeName      = "";
+    broadcast.strOriginalTitle    = "";
+    broadcast.strCast             = "";
+    broadcast.strDirector         = "";
+    broadcast.strWriter           = "";
+    broadcast.iYear               = 0;
+    broadcast.strIMDBNumber       = "";
+    broadcast.iFlags              = EPG_TAG_FLAG_UNDEFINED;
+  }
+
+  virtual void Transfer(const EPG_TAG& broadcast)
+  {
+    PVR->TransferEpgEntry(m_handle, &broadcast);
+  }
+
+private:
+  ADDON_HANDLE m_handle;
+  unsigned int m_channeluid;
+  int m_idoffset;
+};
+
+/**
+ * \brief Fills PVR_RECORDINGs on the job pool and transfers them in order.
+ *        titlecounts holds the number of recordings per title, it is only read.
+ */
+class CRecordingConverter : public CParallelConverter<cRecording, PVR_RECORDING>
+{
+public:
+  CRecordingConverter(CJobPool& pool, ADDON_HANDLE handle, const std::map<std::string, int>& titlecounts) :
+    CParallelConverter<cRecording, PVR_RECORDING>(pool), m_handle(handle), m_titlecounts(titlecounts) {}
+
+protected:
+  virtual void Convert(cRecording& recording, PVR_RECORDING& tag, size_t index)
+  {
+    NOTUSED(index);
+    std::string programtitle = recording.Title();
+
+    memset(&tag, 0 , sizeof(tag));
+
+    PVR_STRCPY(tag.strRecordingId, recording.RecordingId());
+    PVR_STRCPY(tag.strChannelName, recording.ChannelDisplayName());
+    tag.iLifetime      = MAXLIFETIME; //TODO: recording.Lifetime();
+    tag.iPriority      = recording.SchedulePriority();
+    tag.recordingTime  = recording.RecordingStartTime();
+    tag.iDuration      = recording.RecordingStopTime() - recording.RecordingStartTime();
+    PVR_STRCPY(tag.strPlot, recording.Description());
+    tag.iPlayCount     = recording.FullyWatchedCount();
+    tag.iLastPlayedPosition = recording.LastWatchedPosition();
+    std::map<std::string, int>::const_iterator count = m_titlecounts.find(programtitle);
+    if ((count != m_titlecounts.end() && count->second > 1) || g_bUseFolder)
+    {
+      recording.Transform(true);
+      PVR_STRCPY(tag.strDirectory, programtitle.c_str()); //used in XBMC as directory structure below "Server X - hostname"
+    }
+    else
+    {
+      recording.Transform(false);
+      PVR_STRCLR(tag.strDirectory);
+    }
+    PVR_STRCPY(tag.strTitle, recording.Title());
+    PVR_STRCPY(tag.strPlotOutline, recording.SubTitle());
+    PVR_STRCPY(tag.strStreamURL, recording.RecordingFileName());
+
+    /* TODO: PVR API 5.0.0: Implement this */
+    tag.iChannelUid = PVR_CHANNEL_INVALID_UID;
+
+    /* TODO: PVR API 5.1.0: Implement this */
+    tag.channelType = PVR_RECORDING_CHANNEL_TYPE_UNKNOWN;
+  }
+
+  virtual void Transfer(const PVR_RECORDING& tag)
+  {
+    PVR->TransferRecordingEntry(m_handle, &tag);
+  }
+
+private:
+  ADDON_HANDLE m_handle;
+  const std::map<std::string, int>& m_titlecounts;
+};
 
 
 /************************************************************/
@@ -57,10 +172,15 @@ cPVRClientArgusTV::cPVRClientArgusTV()
   m_tsreader               = NULL;
   m_epg_id_offset          = 0;
   m_iCurrentChannel        = -1;
-  m_keepalive              = new CKeepAliveThread();
-  m_eventmonitor           = new CEventsThread();
+  m_scheduler              = new CScheduler();
+  m_keepalive              = new CKeepAliveJob();
+  m_eventmonitor           = new CEventsJob(this);
+  m_epgrevalidate          = new CEpgRevalidateJob(m_epgcache);
+  m_signalquality          = new CSignalQualityJob();
+  m_recordingupdates       = new CRecordingUpdateJob(*m_scheduler, m_recordingcache);
+  m_recordingdeletes       = new CRecordingDeleteJob(*m_scheduler, m_recordingcache);
+  m_convertpool            = new CJobPool(CONVERT_THREADS);
   m_iBackendVersion        = 0;
-  m_signalqualityInterval  = 0;
   m_TVChannels.clear();
   m_RadioChannels.clear();
   // due to lack of static constructors, we initialize manually
@@ -79,8 +199,16 @@ cPVRClientArgusTV::~cPVRClientArgusTV()
   {
     CloseLiveStream();
   }
+  // Stop the jobs before they are deleted
+  m_scheduler->StopThread();
+  delete m_scheduler;
   delete m_keepalive;
   delete m_eventmonitor;
+  delete m_epgrevalidate;
+  delete m_signalquality;
+  delete m_recordingupdates;
+  delete m_recordingdeletes;
+  delete m_convertpool;
   // Free allocated memory for Channels
   FreeChannels(m_TVChannels);
   FreeChannels(m_RadioChannels);
@@ -97,6 +225,10 @@ bool cPVRClientArgusTV::Connect()
 
   XBMC->Log(LOG_INFO, "Connect() - Connecting to %s", g_szBaseURL.c_str());
 
+  // Guide data of the previous session, available until it has been revalidated
+  if (g_iEpgCacheSize > 0)
+    m_epgcache.Load(EpgCacheFile());
+
   int backendversion = ATV_REST_MAXIMUM_API_VERSION;
   int rc = -2;
   int attemps = 0;
@@ -135,6 +267,9 @@ bool cPVRClientArgusTV::Connect()
     }
   }
 
+  // The server may have been reconfigured or updated since the last connection
+  ArgusTV::ClearEmptySchedule();
+
   // Check the accessibility status of all the shares used by ArgusTV tuners
   // TODO: this is temporarily disabled until the caching of smb:// directories is resolved
 //  if (ShareErrorsFound())
@@ -144,13 +279,10 @@ bool cPVRClientArgusTV::Connect()
 
   // Start service events monitor
   m_eventmonitor->Connect();
-  if (!m_eventmonitor->IsRunning()) 
-  {
-    if(!m_eventmonitor->CreateThread()) 
-    {
-      XBMC->Log(LOG_ERROR, "Start service monitor thread failed.");
-    }
-  }
+  m_scheduler->Schedule(m_eventmonitor, 0);
+
+  // Refresh the guide data that was loaded from the cache file
+  m_scheduler->Schedule(m_epgrevalidate, 0);
   m_bConnected = true;
   return true;
 }
@@ -160,14 +292,26 @@ void cPVRClientArgusTV::Disconnect()
   string result;
 
   XBMC->Log(LOG_INFO, "Disconnect");
+  m_zapstats.LogHistograms();
 
   // Stop service events monitor
-  if (m_eventmonitor->IsRunning()) 
+  m_scheduler->Cancel(m_eventmonitor);
+
+  // Send the watched state changes that are still queued
+  m_scheduler->Cancel(m_recordingupdates);
+  m_recordingupdates->Flush();
+
+  // Finish the queued deletions
+  m_scheduler->Cancel(m_recordingdeletes);
+  m_recordingdeletes->Flush();
+
+  // Stop the EPG revalidation and keep the guide data for the next session
+  m_scheduler->Cancel(m_epgrevalidate);
+  if (g_iEpgCacheSize > 0)
   {
-    if (!m_eventmonitor->StopThread())
-    {
-      XBMC->Log(LOG_ERROR, "Stop service monitor thread failed.");
-    }
+    if (!XBMC->DirectoryExists(g_szUserPath.c_str()))
+      XBMC->CreateDirectory(g_szUserPath.c_str());
+    m_epgcache.Save(EpgCacheFile());
   }
 
   if (m_bTimeShiftStarted)
@@ -317,73 +461,20 @@ PVR_ERROR cPVRClientArgusTV::GetEpg(ADDON_HANDLE handle, const PVR_CHANNEL &chan
   cChannel* atvchannel = FetchChannel(channel.iUniqueId);
   XBMC->Log(LOG_DEBUG, "ARGUS TV channel %p)", atvchannel);
 
-  struct tm* convert = localtime(&iStart);
-  struct tm tm_start = *convert;
-  convert = localtime(&iEnd);
-  struct tm tm_end = *convert;
-
   if(atvchannel)
   {
-    Json::Value response;
-    int retval;
+    std::vector<cEpg> programs;
 
     XBMC->Log(LOG_DEBUG, "Getting EPG Data for ARGUS TV channel %s)", atvchannel->GuideChannelID().c_str());
-    retval = ArgusTV::GetEPGData(atvchannel->GuideChannelID(), tm_start, tm_end, response);
-
-    if (retval != E_FAILED)
-    {
-      XBMC->Log(LOG_DEBUG, "GetEPGData returned %i, response.type == %i, response.size == %i.", retval, response.type(), response.size());
-      if( response.type() == Json::arrayValue)
-      {
-        int size = response.size();
-        EPG_TAG broadcast;
-        cEpg epg;
-
-        memset(&broadcast, 0, sizeof(EPG_TAG));
-
-        // parse channel list
-        for ( int index =0; index < size; ++index )
-        {
-          if (epg.Parse(response[index]))
-          {
-            m_epg_id_offset++;
-            broadcast.iUniqueBroadcastId  = m_epg_id_offset;
-            broadcast.strTitle            = epg.Title();
-            broadcast.iChannelNumber      = channel.iUniqueId;
-            broadcast.startTime           = epg.StartTime();
-            broadcast.endTime             = epg.EndTime();
-            broadcast.strPlotOutline      = epg.Subtitle();
-            broadcast.strPlot             = epg.Description();
-            broadcast.strIconPath         = "";
-            broadcast.iGenreType          = EPG_GENRE_USE_STRING;
-            broadcast.iGenreSubType       = 0;
-            broadcast.strGenreDescription = epg.Genre();
-            broadcast.firstAired          = 0;
-            broadcast.iParentalRating     = 0;
-            broadcast.iStarRating         = 0;
-            broadcast.bNotify             = false;
-            broadcast.iSeriesNumber       = 0;
-            broadcast.iEpisodeNumber      = 0;
-            broadcast.iEpisodePartNumber  = 0;
-            broadcast.strEpisodeName      = "";
-            broadcast.strOriginalTitle    = "";
-            broadcast.strCast             = "";
-            broadcast.strDirector         = "";
-            broadcast.strWriter           = "";
-            broadcast.iYear               = 0;
-            broadcast.strIMDBNumber       = "";
-            broadcast.iFlags              = EPG_TAG_FLAG_UNDEFINED;
-
-            PVR->TransferEpgEntry(handle, &broadcast);
-          }
-          epg.Reset();
-        }
-      }
-    }
-    else
+    if (!m_epgcache.GetPrograms(atvchannel->GuideChannelID(), channel.iUniqueId, iStart, iEnd, programs))
     {
       XBMC->Log(LOG_ERROR, "GetEPGData failed for channel id:%i", channel.iUniqueId);
     }
+
+    XBMC->Log(LOG_DEBUG, "Transferring %i EPG entries.", (int) programs.size());
+    CEpgConverter converter(*m_convertpool, handle, channel.iUniqueId, m_epg_id_offset);
+    converter.Run(programs);
+    m_epg_id_offset += (int) programs.size();
   }
   else
   {
@@ -394,6 +485,40 @@ PVR_ERROR cPVRClientArgusTV::GetEpg(ADDON_HANDLE handle, const PVR_CHANNEL &chan
   return PVR_ERROR_NO_ERROR;
 }
 
+PVR_ERROR cPVRClientArgusTV::SetEPGTimeFrame(int iDays)
+{
+  XBMC->Log(LOG_DEBUG, "->SetEPGTimeFrame(%i)", iDays);
+  m_epgcache.SetTimeFrame(iDays);
+  return PVR_ERROR_NO_ERROR;
+}
+
+void cPVRClientArgusTV::OnGuideDataChanged(void)
+{
+  m_epgcache.Clear();
+}
+
+void cPVRClientArgusTV::OnRecordingChanged(const std::string& recordingid)
+{
+  if (recordingid.empty())
+    m_recordingcache.Invalidate();
+  else
+    m_recordingcache.UpdateRecording(recordingid);
+}
+
+void cPVRClientArgusTV::OnTimersChanged(void)
+{
+  m_timercache.Invalidate();
+}
+
+std::string cPVRClientArgusTV::EpgCacheFile(void)
+{
+  std::string filename = g_szUserPath;
+  if (!filename.empty() && filename[filename.length() - 1] != '/' && filename[filename.length() - 1] != '\\')
+    filename += PATH_SEPARATOR_CHAR;
+  filename += "epgcache.bin";
+  return filename;
+}
+
 /************************************************************/
 /** Channel handling */
 
@@ -637,98 +762,27 @@ PVR_ERROR cPVRClientArgusTV::GetChannelGroupMembers(ADDON_HANDLE handle, const P
 
 int cPVRClientArgusTV::GetNumRecordings(void)
 {
-  Json::Value response;
-  int retval = -1;
-  int iNumRecordings = 0;
-
   XBMC->Log(LOG_DEBUG, "GetNumRecordings()");
-  retval = ArgusTV::GetRecordingGroupByTitle(response);
-  if (retval >= 0)
-  {
-    int size = response.size();
-
-    // parse channelgroup list
-    for ( int index = 0; index < size; ++index )
-    {
-      cRecordingGroup recordinggroup;
-      if (recordinggroup.Parse(response[index]))
-      {
-        iNumRecordings += recordinggroup.RecordingsCount();
-      }
-    }
-  }
-  return iNumRecordings;
+  return m_recordingcache.GetNumRecordings();
 }
 
 PVR_ERROR cPVRClientArgusTV::GetRecordings(ADDON_HANDLE handle)
 {
-  Json::Value recordinggroupresponse;
-  int retval = -1;
+  std::vector<cRecording> recordings;
   int iNumRecordings = 0;
 
   XBMC->Log(LOG_DEBUG, "RequestRecordingsList()");
   int64_t t = GetTimeMs();
-  retval = ArgusTV::GetRecordingGroupByTitle(recordinggroupresponse);
-  if(retval >= 0)
-  {           
-    // process list of recording groups
-    int size = recordinggroupresponse.size();
-    for ( int recordinggroupindex = 0; recordinggroupindex < size; ++recordinggroupindex )
-    {
-      cRecordingGroup recordinggroup;
-      if (recordinggroup.Parse(recordinggroupresponse[recordinggroupindex]))
-      {
-        Json::Value recordingsbytitleresponse;
-        retval = ArgusTV::GetFullRecordingsForTitle(recordinggroup.ProgramTitle(), recordingsbytitleresponse);
-        if (retval >= 0)
-        {
-          // process list of recording details for this group
-          int nrOfRecordings = recordingsbytitleresponse.size();
-          for (int recordingindex = 0; recordingindex < nrOfRecordings; recordingindex++)
-          {
-            cRecording recording;
-
-            if (recording.Parse(recordingsbytitleresponse[recordingindex]))
-            {
-              PVR_RECORDING tag;
-              memset(&tag, 0 , sizeof(tag));
-
-              PVR_STRCPY(tag.strRecordingId, recording.RecordingId());
-              PVR_STRCPY(tag.strChannelName, recording.ChannelDisplayName());
-              tag.iLifetime      = MAXLIFETIME; //TODO: recording.Lifetime();
-              tag.iPriority      = recording.SchedulePriority();
-              tag.recordingTime  = recording.RecordingStartTime();
-              tag.iDuration      = recording.RecordingStopTime() - recording.RecordingStartTime();
-              PVR_STRCPY(tag.strPlot, recording.Description());
-              tag.iPlayCount     = recording.FullyWatchedCount();
-              tag.iLastPlayedPosition = recording.LastWatchedPosition();
-              if (nrOfRecordings > 1 || g_bUseFolder)
-              {
-                recording.Transform(true);
-                PVR_STRCPY(tag.strDirectory, recordinggroup.ProgramTitle().c_str()); //used in XBMC as directory structure below "Server X - hostname"
-              }
-              else
-              {
-                recording.Transform(false);
-                PVR_STRCLR(tag.strDirectory);
-              }
-              PVR_STRCPY(tag.strTitle, recording.Title());
-              PVR_STRCPY(tag.strPlotOutline, recording.SubTitle());
-              PVR_STRCPY(tag.strStreamURL, recording.RecordingFileName());
-
-              /* TODO: PVR API 5.0.0: Implement this */
-              tag.iChannelUid = PVR_CHANNEL_INVALID_UID;
-
-              /* TODO: PVR API 5.1.0: Implement this */
-              tag.channelType = PVR_RECORDING_CHANNEL_TYPE_UNKNOWN;
-
-              PVR->TransferRecordingEntry(handle, &tag);
-              iNumRecordings++;
-            }
-          }
-        }
-      }
-    }
+  if (m_recordingcache.GetRecordings(recordings))
+  {
+    // Recordings of a title with more than one recording go into a directory named after the title
+    std::map<std::string, int> titlecounts;
+    for (std::vector<cRecording>::const_iterator it = recordings.begin(); it != recordings.end(); ++it)
+      titlecounts[it->Title()]++;
+
+    CRecordingConverter converter(*m_convertpool, handle, titlecounts);
+    converter.Run(recordings);
+    iNumRecordings = (int) recordings.size();
   }
   t = GetTimeMs() - t;
   XBMC->Log(LOG_INFO, "Retrieving %d recordings took %d milliseconds.", iNumRecordings, t);
@@ -737,24 +791,14 @@ PVR_ERROR cPVRClientArgusTV::GetRecordings(ADDON_HANDLE handle)
 
 PVR_ERROR cPVRClientArgusTV::DeleteRecording(const PVR_RECORDING &recinfo)
 {
-  PVR_ERROR rc = PVR_ERROR_FAILED;
+  XBMC->Log(LOG_DEBUG, "->DeleteRecording(%s == \"%s\")", recinfo.strRecordingId, recinfo.strStreamURL);
 
-  XBMC->Log(LOG_DEBUG, "->DeleteRecording(%s)", recinfo.strRecordingId);
-  std::string UNCname = ToUNC(recinfo.strStreamURL);
-
-  XBMC->Log(LOG_DEBUG, "->DeleteRecording(%s == \"%s\")", recinfo.strRecordingId, UNCname.c_str());
-  // JSONify the stream_url
-  Json::Value recordingname (UNCname);
-  Json::FastWriter writer;
-  std::string jsonval = writer.write(recordingname);
-  if (ArgusTV::DeleteRecording(jsonval) >= 0)
-  {
-    // Trigger XBMC to update it's list
-    PVR->TriggerRecordingUpdate();
-    rc =  PVR_ERROR_NO_ERROR;
-  }
+  // Deleted on the server in the background; restored when that fails
+  m_recordingdeletes->Delete(recinfo.strRecordingId, recinfo.strStreamURL);
 
-  return rc;
+  // Trigger XBMC to update it's list
+  PVR->TriggerRecordingUpdate();
+  return PVR_ERROR_NO_ERROR;
 }
 
 PVR_ERROR cPVRClientArgusTV::RenameRecording(const PVR_RECORDING &recinfo)
@@ -767,18 +811,9 @@ PVR_ERROR cPVRClientArgusTV::SetRecordingLastPlayedPosition(const PVR_RECORDING
 {
   XBMC->Log(LOG_DEBUG, "->SetRecordingLastPlayedPosition(index=%s [%s], %d)", recinfo.strRecordingId, recinfo.strStreamURL, lastplayedposition);
 
-  std::string recordingfilename = ToUNC(recinfo.strStreamURL);
-
-  // JSONify the stream_url
-  Json::Value recordingname (recordingfilename);
-  Json::FastWriter writer;
-  std::string jsonval = writer.write(recordingname);
-  int retval = ArgusTV::SetRecordingLastWatchedPosition(jsonval, lastplayedposition);
-  if (retval < 0)
-  {
-    XBMC->Log(LOG_INFO, "Failed to set recording last watched position (%d)", retval);
-    return PVR_ERROR_SERVER_ERROR;
-  }
+  // Sent to the server in the background
+  m_recordingupdates->SetLastWatchedPosition(recinfo.strStreamURL, lastplayedposition);
+  m_recordingcache.SetLastWatchedPosition(recinfo.strRecordingId, recinfo.strStreamURL, lastplayedposition);
 
   return PVR_ERROR_NO_ERROR;
 }
@@ -787,6 +822,10 @@ int cPVRClientArgusTV::GetRecordingLastPlayedPosition(const PVR_RECORDING &recin
 {
   XBMC->Log(LOG_DEBUG, "->GetRecordingLastPlayedPosition(index=%s [%s])", recinfo.strRecordingId, recinfo.strStreamURL);
 
+  int position, playcount;
+  if (m_recordingcache.GetResumeInfo(recinfo.strRecordingId, recinfo.strStreamURL, position, playcount))
+    return position;
+
   std::string recordingfilename = ToUNC(recinfo.strStreamURL);
 
   // JSONify the stream_url
@@ -811,18 +850,9 @@ PVR_ERROR cPVRClientArgusTV::SetRecordingPlayCount(const PVR_RECORDING &recinfo,
 {
   XBMC->Log(LOG_DEBUG, "->SetRecordingPlayCount(index=%s [%s], %d)", recinfo.strRecordingId, recinfo.strStreamURL, playcount);
 
-  std::string recordingfilename = ToUNC(recinfo.strStreamURL);
-
-  // JSONify the stream_url
-  Json::Value recordingname (recordingfilename);
-  Json::FastWriter writer;
-  std::string jsonval = writer.write(recordingname);
-  int retval = ArgusTV::SetRecordingFullyWatchedCount(jsonval, playcount);
-  if (retval < 0)
-  {
-    XBMC->Log(LOG_INFO, "Failed to set recording play count (%d)", retval);
-    return PVR_ERROR_SERVER_ERROR;
-  }
+  // Sent to the server in the background
+  m_recordingupdates->SetFullyWatchedCount(recinfo.strStreamURL, playcount);
+  m_recordingcache.SetFullyWatchedCount(recinfo.strRecordingId, recinfo.strStreamURL, playcount);
 
   return PVR_ERROR_NO_ERROR;
 }
@@ -833,121 +863,79 @@ PVR_ERROR cPVRClientArgusTV::SetRecordingPlayCount(const PVR_RECORDING &recinfo,
 
 int cPVRClientArgusTV::GetNumTimers(void)
 {
-  // Not directly possible in ARGUS TV
-  Json::Value response;
-
   XBMC->Log(LOG_DEBUG, "GetNumTimers()");
-  // pick up the schedulelist for TV
-  int retval = ArgusTV::GetUpcomingRecordings(response);
-  if (retval < 0) 
-  {
-    return 0;
-  }
-
-  return response.size();
+  return m_timercache.GetNumTimers();
 }
 
 PVR_ERROR cPVRClientArgusTV::GetTimers(ADDON_HANDLE handle)
 {
-  Json::Value activeRecordingsResponse, upcomingRecordingsResponse;
-  int         iNumberOfTimers = 0;
+  std::vector<cTimerCache::Timer> timers;
   PVR_TIMER   tag;
-  int         numberoftimers;
 
   XBMC->Log(LOG_DEBUG, "%s", __FUNCTION__);
 
-  // retrieve the currently active recordings
-  int retval = ArgusTV::GetActiveRecordings(activeRecordingsResponse);
-  if (retval < 0) 
-  {
-    XBMC->Log(LOG_ERROR, "Unable to retrieve active recordings from server.");
+  // the upcoming recordings, joined with the currently active recordings
+  if (!m_timercache.GetTimers(timers))
     return PVR_ERROR_SERVER_ERROR;
-  }
-
-  // pick up the upcoming recordings
-  retval = ArgusTV::GetUpcomingRecordings(upcomingRecordingsResponse);
-  if (retval < 0) 
-  {
-    XBMC->Log(LOG_ERROR, "Unable to retrieve upcoming programs from server.");
-    return PVR_ERROR_SERVER_ERROR;
-  }
 
   memset(&tag, 0 , sizeof(tag));
-  numberoftimers = upcomingRecordingsResponse.size();
 
-  for (int i = 0; i < numberoftimers; i++)
+  for (std::vector<cTimerCache::Timer>::const_iterator it = timers.begin(); it != timers.end(); ++it)
   {
-    cUpcomingRecording upcomingrecording;
-    if (upcomingrecording.Parse(upcomingRecordingsResponse[i]))
-    {
-      /* TODO: Implement own timer types to get support for the timer features introduced with PVR API 1.9.7 */
-      tag.iTimerType = PVR_TIMER_TYPE_NONE;
+    const cUpcomingRecording& upcomingrecording = it->upcoming;
 
-      tag.iClientIndex      = upcomingrecording.ID();
-      tag.iClientChannelUid = upcomingrecording.ChannelID();
-      tag.startTime         = upcomingrecording.StartTime();
-      tag.endTime           = upcomingrecording.StopTime();
+    /* TODO: Implement own timer types to get support for the timer features introduced with PVR API 1.9.7 */
+    tag.iTimerType = PVR_TIMER_TYPE_NONE;
 
-      // build the XBMC PVR State
-      if (upcomingrecording.IsCancelled())
-      {
-        tag.state             = PVR_TIMER_STATE_CANCELLED;
-      }
-      else if (upcomingrecording.IsInConflict())
-      {
-        if (upcomingrecording.IsAllocated())
-          tag.state             = PVR_TIMER_STATE_CONFLICT_OK;
-        else
-          tag.state             = PVR_TIMER_STATE_CONFLICT_NOK;
-      }
-      else if (!upcomingrecording.IsAllocated())
-      {
-        //not allocated --> won't be recorded
-        tag.state             = PVR_TIMER_STATE_ERROR;
-      }
-      else
-      {
-        tag.state             = PVR_TIMER_STATE_SCHEDULED;
-      }
+    tag.iClientIndex      = upcomingrecording.ID();
+    tag.iClientChannelUid = upcomingrecording.ChannelID();
+    tag.startTime         = upcomingrecording.StartTime();
+    tag.endTime           = upcomingrecording.StopTime();
 
-      if (tag.state == PVR_TIMER_STATE_SCHEDULED || tag.state == PVR_TIMER_STATE_CONFLICT_OK) //check if they are currently recording
-      {
-        if (activeRecordingsResponse.size() > 0)
-        {
-          // Is the this upcoming recording in the list of active recordings?
-          for (Json::Value::UInt j = 0; j < activeRecordingsResponse.size(); j++)
-          {
-            cActiveRecording activerecording;
-            if (activerecording.Parse(activeRecordingsResponse[j]))
-            {
-              if (upcomingrecording.UpcomingProgramId() == activerecording.UpcomingProgramId())
-              {
-                tag.state = PVR_TIMER_STATE_RECORDING;
-                break;
-              }
-            }
-          }
-        }
-      }
+    // build the XBMC PVR State
+    if (upcomingrecording.IsCancelled())
+    {
+      tag.state             = PVR_TIMER_STATE_CANCELLED;
+    }
+    else if (upcomingrecording.IsInConflict())
+    {
+      if (upcomingrecording.IsAllocated())
+        tag.state             = PVR_TIMER_STATE_CONFLICT_OK;
+      else
+        tag.state             = PVR_TIMER_STATE_CONFLICT_NOK;
+    }
+    else if (!upcomingrecording.IsAllocated())
+    {
+      //not allocated --> won't be recorded
+      tag.state             = PVR_TIMER_STATE_ERROR;
+    }
+    else
+    {
+      tag.state             = PVR_TIMER_STATE_SCHEDULED;
+    }
 
-      PVR_STRCPY(tag.strTitle, upcomingrecording.Title().c_str());
-      tag.strDirectory[0]   = '\0';
-      tag.strSummary[0]     = '\0';
-      tag.iPriority         = 0;
-      tag.iLifetime         = 0;
-      tag.firstDay          = 0;
-      tag.iWeekdays         = 0;
-      tag.iEpgUid           = 0;
-      tag.iMarginStart      = upcomingrecording.PreRecordSeconds() / 60;
-      tag.iMarginEnd        = upcomingrecording.PostRecordSeconds() / 60;
-      tag.iGenreType        = 0;
-      tag.iGenreSubType     = 0;
-
-      PVR->TransferTimerEntry(handle, &tag);
-      XBMC->Log(LOG_DEBUG, "Found timer: %s, Unique id: %d, ARGUS ProgramId: %d, ARGUS ChannelId: %d\n",
-        tag.strTitle, tag.iClientIndex, upcomingrecording.ID(), upcomingrecording.ChannelID());
-      iNumberOfTimers++;
+    if (tag.state == PVR_TIMER_STATE_SCHEDULED || tag.state == PVR_TIMER_STATE_CONFLICT_OK) //check if they are currently recording
+    {
+      if (it->IsRecording())
+        tag.state = PVR_TIMER_STATE_RECORDING;
     }
+
+    PVR_STRCPY(tag.strTitle, upcomingrecording.Title().c_str());
+    tag.strDirectory[0]   = '\0';
+    tag.strSummary[0]     = '\0';
+    tag.iPriority         = 0;
+    tag.iLifetime         = 0;
+    tag.firstDay          = 0;
+    tag.iWeekdays         = 0;
+    tag.iEpgUid           = 0;
+    tag.iMarginStart      = upcomingrecording.PreRecordSeconds() / 60;
+    tag.iMarginEnd        = upcomingrecording.PostRecordSeconds() / 60;
+    tag.iGenreType        = 0;
+    tag.iGenreSubType     = 0;
+
+    PVR->TransferTimerEntry(handle, &tag);
+    XBMC->Log(LOG_DEBUG, "Found timer: %s, Unique id: %d, ARGUS ProgramId: %d, ARGUS ChannelId: %d\n",
+      tag.strTitle, tag.iClientIndex, upcomingrecording.ID(), upcomingrecording.ChannelID());
   }
 
   return PVR_ERROR_NO_ERROR;
@@ -970,56 +958,89 @@ PVR_ERROR cPVRClientArgusTV::AddTimer(const PVR_TIMER &timerinfo)
   XBMC->Log(LOG_DEBUG, "%s: XBMC channel %d translated to ARGUS channel %s.", __FUNCTION__,
     timerinfo.iClientChannelUid, pChannel->Guid().c_str());
 
-  // Try to get original EPG data from ARGUS
-  struct tm* convert = localtime(&timerinfo.startTime);
-  struct tm tm_start = *convert;
-  convert = localtime(&timerinfo.endTime);
-  struct tm tm_end = *convert;
-
-  Json::Value epgResponse;
-  XBMC->Log(LOG_DEBUG, "%s: Getting EPG Data for ARGUS TV channel %s", __FUNCTION__, pChannel->GuideChannelID().c_str());
-  int retval = ArgusTV::GetEPGData(pChannel->GuideChannelID(), tm_start, tm_end, epgResponse);
+  time_t starttime = timerinfo.startTime;
+  if (starttime == 0) starttime = time(NULL);
 
+  // Try to get original EPG data, from the guide cache if possible
   std::string programTitle = timerinfo.strTitle;
-  if (retval >= 0)
+  bool programFound = true; // unless the guide shows there is no program to match a one-time schedule
+  cEpg epg;
+  int retval;
+  switch (m_epgcache.FindProgram(pChannel->GuideChannelID(), starttime, timerinfo.endTime, epg))
   {
-    XBMC->Log(LOG_DEBUG, "%s: Getting EPG Data for ARGUS TV channel %s returned %d entries.", __FUNCTION__, pChannel->GuideChannelID().c_str(), epgResponse.size());
-    if (epgResponse.size() > 0)
+    case cEpgCache::LOOKUP_FOUND:
+      XBMC->Log(LOG_DEBUG, "%s: Found program in the EPG cache for ARGUS TV channel %s.", __FUNCTION__, pChannel->GuideChannelID().c_str());
+      programTitle = epg.Title();
+      break;
+    case cEpgCache::LOOKUP_NONE:
+      XBMC->Log(LOG_DEBUG, "%s: No program in the EPG cache for ARGUS TV channel %s.", __FUNCTION__, pChannel->GuideChannelID().c_str());
+      programFound = false;
+      break;
+    default:
     {
-      programTitle = epgResponse[0u]["Title"].asString();
+      struct tm* convert = localtime(&timerinfo.startTime);
+      struct tm tm_start = *convert;
+      convert = localtime(&timerinfo.endTime);
+      struct tm tm_end = *convert;
+
+      Json::Value epgResponse;
+      XBMC->Log(LOG_DEBUG, "%s: Getting EPG Data for ARGUS TV channel %s", __FUNCTION__, pChannel->GuideChannelID().c_str());
+      retval = ArgusTV::GetEPGData(pChannel->GuideChannelID(), tm_start, tm_end, epgResponse);
+
+      if (retval >= 0)
+      {
+        XBMC->Log(LOG_DEBUG, "%s: Getting EPG Data for ARGUS TV channel %s returned %d entries.", __FUNCTION__, pChannel->GuideChannelID().c_str(), epgResponse.size());
+        if (epgResponse.size() > 0)
+        {
+          programTitle = epgResponse[0u]["Title"].asString();
+        }
+        else
+        {
+          programFound = false;
+        }
+      }
+      else
+      {
+        XBMC->Log(LOG_DEBUG, "%s: Getting EPG Data for ARGUS TV channel %s failed.", __FUNCTION__, pChannel->GuideChannelID().c_str());
+      }
     }
   }
-  else
-  {
-    XBMC->Log(LOG_DEBUG, "%s: Getting EPG Data for ARGUS TV channel %s failed.", __FUNCTION__, pChannel->GuideChannelID().c_str());
-  }
 
   Json::Value addScheduleResponse;
-  time_t starttime = timerinfo.startTime;
-  if (starttime == 0) starttime = time(NULL);
-  retval = ArgusTV::AddOneTimeSchedule(pChannel->Guid(), starttime, programTitle, timerinfo.iMarginStart * 60, timerinfo.iMarginEnd * 60, timerinfo.iLifetime, addScheduleResponse);
-  if (retval < 0) 
+  if (programFound)
   {
-    return PVR_ERROR_SERVER_ERROR;
-  }
+    retval = ArgusTV::AddOneTimeSchedule(pChannel->Guid(), starttime, programTitle, timerinfo.iMarginStart * 60, timerinfo.iMarginEnd * 60, timerinfo.iLifetime, addScheduleResponse);
+    if (retval < 0) 
+    {
+      return PVR_ERROR_SERVER_ERROR;
+    }
 
-  std::string scheduleid = addScheduleResponse["ScheduleId"].asString();
+    std::string scheduleid = addScheduleResponse["ScheduleId"].asString();
 
-  XBMC->Log(LOG_DEBUG, "%s: ARGUS one-time schedule added with id %s.", __FUNCTION__,
-    scheduleid.c_str());
+    XBMC->Log(LOG_DEBUG, "%s: ARGUS one-time schedule added with id %s.", __FUNCTION__,
+      scheduleid.c_str());
 
 
-  // Ok, we created a schedule, but did that lead to an upcoming recording?
-  Json::Value upcomingProgramsResponse;
-  retval = ArgusTV::GetUpcomingProgramsForSchedule(addScheduleResponse, upcomingProgramsResponse);
+    // Ok, we created a schedule, but did that lead to an upcoming recording?
+    Json::Value upcomingProgramsResponse;
+    retval = ArgusTV::GetUpcomingProgramsForSchedule(addScheduleResponse, upcomingProgramsResponse);
 
-  // We should have at least one upcoming program for this schedule, otherwise nothing will be recorded
-  if (retval <= 0)
+    // We should have at least one upcoming program for this schedule, otherwise nothing will be recorded
+    if (retval <= 0)
+    {
+      XBMC->Log(LOG_INFO, "The new schedule does not lead to an upcoming program, removing schedule and adding a manual one.");
+      // remove the added (now stale) schedule, ignore failure (what are we to do anyway?)
+      ArgusTV::DeleteSchedule(scheduleid);
+      programFound = false;
+    }
+  }
+  else
   {
-    XBMC->Log(LOG_INFO, "The new schedule does not lead to an upcoming program, removing schedule and adding a manual one.");
-    // remove the added (now stale) schedule, ignore failure (what are we to do anyway?)
-    ArgusTV::DeleteSchedule(scheduleid);
+    XBMC->Log(LOG_INFO, "There is no program to match, adding a manual schedule.");
+  }
 
+  if (!programFound)
+  {
     // Okay, add a manual schedule (forced recording) but now we need to add pre- and post-recording ourselves
     time_t manualStartTime = starttime - (timerinfo.iMarginStart * 60);
     time_t manualEndTime = timerinfo.endTime + (timerinfo.iMarginEnd * 60);
@@ -1032,6 +1053,7 @@ PVR_ERROR cPVRClientArgusTV::AddTimer(const PVR_TIMER &timerinfo)
   }
 
   // Trigger an update of the PVR timers
+  m_timercache.Invalidate();
   PVR->TriggerTimerUpdate();
   return PVR_ERROR_NO_ERROR;
 }
@@ -1039,89 +1061,56 @@ PVR_ERROR cPVRClientArgusTV::AddTimer(const PVR_TIMER &timerinfo)
 PVR_ERROR cPVRClientArgusTV::DeleteTimer(const PVR_TIMER &timerinfo, bool force)
 {
   NOTUSED(force);
-  Json::Value upcomingProgramsResponse, activeRecordingsResponse;
+  int retval;
 
   XBMC->Log(LOG_DEBUG, "DeleteTimer()");
 
-  // retrieve the currently active recordings
-  int retval = ArgusTV::GetActiveRecordings(activeRecordingsResponse);
-  if (retval < 0) 
-  {
-    XBMC->Log(LOG_ERROR, "Unable to retrieve active recordings from server.");
+  // try to find the upcoming recording that matches this xbmc timer
+  cTimerCache::Timer timer;
+  if (!m_timercache.FindTimer((int) timerinfo.iClientIndex, timer))
     return PVR_ERROR_SERVER_ERROR;
-  }
 
-  // pick up the upcoming recordings
-  retval = ArgusTV::GetUpcomingRecordings(upcomingProgramsResponse);
-  if (retval < 0) 
-  {
-    XBMC->Log(LOG_ERROR, "Unable to retrieve upcoming programs from server.");
-    return PVR_ERROR_SERVER_ERROR;
-  }
+  const cUpcomingRecording& upcomingrecording = timer.upcoming;
 
-  // try to find the upcoming recording that matches this xbmc timer
-  int numberoftimers = upcomingProgramsResponse.size();
-  for (int i = 0; i < numberoftimers; i++)
+  // Okay, we matched the timer to an upcoming program, but is it recording right now?
+  if (timer.IsRecording())
   {
-    cUpcomingRecording upcomingrecording;
-    if (upcomingrecording.Parse(upcomingProgramsResponse[i]))
+    // Abort this recording
+    retval = ArgusTV::AbortActiveRecording(timer.activerecording);
+    if (retval != 0)
     {
-      if (upcomingrecording.ID() == (int) timerinfo.iClientIndex)
-      {
-        // Okay, we matched the timer to an upcoming program, but is it recording right now?
-        if (activeRecordingsResponse.size() > 0)
-        {
-          // Is the this upcoming program in the list of active recordings?
-          for (Json::Value::UInt j = 0; j < activeRecordingsResponse.size(); j++)
-          {
-            cActiveRecording activerecording;
-            if (activerecording.Parse(activeRecordingsResponse[j]))
-            {
-              if (upcomingrecording.UpcomingProgramId() == activerecording.UpcomingProgramId())
-              {
-                // Abort this recording
-                retval = ArgusTV::AbortActiveRecording(activeRecordingsResponse[j]);
-                if (retval != 0)
-                {
-                  XBMC->Log(LOG_ERROR, "Unable to cancel the active recording of \"%s\" on the server. Will try to cancel the program.", upcomingrecording.Title().c_str());
-                }
-                break;
-              }
-            }
-          }
-        }
+      XBMC->Log(LOG_ERROR, "Unable to cancel the active recording of \"%s\" on the server. Will try to cancel the program.", upcomingrecording.Title().c_str());
+    }
+  }
 
-        Json::Value scheduleResponse;
-        retval = ArgusTV::GetScheduleById(upcomingrecording.ScheduleId(), scheduleResponse);
-        std::string schedulename = scheduleResponse["Name"].asString();
+  Json::Value scheduleResponse;
+  retval = ArgusTV::GetScheduleById(upcomingrecording.ScheduleId(), scheduleResponse);
+  std::string schedulename = scheduleResponse["Name"].asString();
 
-        if (scheduleResponse["IsOneTime"].asBool() == true)
-        {
-          retval = ArgusTV::DeleteSchedule(upcomingrecording.ScheduleId());
-          if (retval < 0)
-          {
-            XBMC->Log(LOG_NOTICE, "Unable to delete schedule %s from server.", schedulename.c_str());
-            return PVR_ERROR_SERVER_ERROR;
-          }
-        }
-        else
-        {
-          retval = ArgusTV::CancelUpcomingProgram(upcomingrecording.ScheduleId(), upcomingrecording.ChannelId(), 
-            upcomingrecording.StartTime(), upcomingrecording.GuideProgramId());
-          if (retval < 0) 
-          {
-            XBMC->Log(LOG_ERROR, "Unable to cancel upcoming program from server.");
-            return PVR_ERROR_SERVER_ERROR;
-          }
-        }
-
-        // Trigger an update of the PVR timers
-        PVR->TriggerTimerUpdate();
-        return PVR_ERROR_NO_ERROR;
-      }
+  if (scheduleResponse["IsOneTime"].asBool() == true)
+  {
+    retval = ArgusTV::DeleteSchedule(upcomingrecording.ScheduleId());
+    if (retval < 0)
+    {
+      XBMC->Log(LOG_NOTICE, "Unable to delete schedule %s from server.", schedulename.c_str());
+      return PVR_ERROR_SERVER_ERROR;
     }
   }
-  return PVR_ERROR_SERVER_ERROR;
+  else
+  {
+    retval = ArgusTV::CancelUpcomingProgram(upcomingrecording.ScheduleId(), upcomingrecording.ChannelId(), 
+      upcomingrecording.StartTime(), upcomingrecording.GuideProgramId());
+    if (retval < 0) 
+    {
+      XBMC->Log(LOG_ERROR, "Unable to cancel upcoming program from server.");
+      return PVR_ERROR_SERVER_ERROR;
+    }
+  }
+
+  // Trigger an update of the PVR timers
+  m_timercache.Invalidate();
+  PVR->TriggerTimerUpdate();
+  return PVR_ERROR_NO_ERROR;
 }
 
 PVR_ERROR cPVRClientArgusTV::UpdateTimer(const PVR_TIMER &timerinfo)
@@ -1182,8 +1171,10 @@ bool cPVRClientArgusTV::_OpenLiveStream(const PVR_CHANNEL &channelinfo)
   }
 
   m_iCurrentChannel = -1; // make sure that it is not a valid channel nr in case it will fail lateron
+  m_zapstats.Start(channelinfo.iUniqueId);
 
   cChannel* channel = FetchChannel(channelinfo.iUniqueId);
+  m_zapstats.Mark(ZAP_FETCHCHANNEL);
 
   if (channel)
   {
@@ -1192,6 +1183,7 @@ bool cPVRClientArgusTV::_OpenLiveStream(const PVR_CHANNEL &channelinfo)
     XBMC->Log(LOG_INFO, "Corresponding ARGUS TV channel: %s", channel->Guid().c_str());
 
     int retval = ArgusTV::TuneLiveStream(channel->Guid(), channel->Type(), channel->Name(), filename);
+    m_zapstats.Mark(ZAP_TUNE);
     if (retval == ArgusTV::NoReTunePossible)
     {
       // Ok, we can't re-tune with the current live stream still running
@@ -1199,6 +1191,7 @@ bool cPVRClientArgusTV::_OpenLiveStream(const PVR_CHANNEL &channelinfo)
       CloseLiveStream();
       XBMC->Log(LOG_INFO, "Re-Tune XBMC channel: %i", channelinfo.iUniqueId);
       retval = ArgusTV::TuneLiveStream(channel->Guid(), channel->Type(), channel->Name(), filename);
+      m_zapstats.Mark(ZAP_RETUNE);
     }
 
     if (retval != E_SUCCESS)
@@ -1225,27 +1218,26 @@ bool cPVRClientArgusTV::_OpenLiveStream(const PVR_CHANNEL &channelinfo)
     }
 
     filename = ToCIFS(filename);
+    m_zapstats.Mark(ZAP_TOCIFS);
 
     if (retval != E_SUCCESS || filename.length() == 0)
     {
       XBMC->Log(LOG_ERROR, "Could not start the timeshift for channel %i (%s)", channelinfo.iUniqueId, channel->Guid().c_str());
+      m_zapstats.Abort("tune failed");
       CloseLiveStream();
       return false;
     }
 
-    // reset the signal quality poll interval after tuning
-    m_signalqualityInterval = 0;
+    // forget the signal quality of the previous channel and sample the new one right away when it is shown
+    m_signalquality->Reset();
+    if (m_scheduler->IsScheduled(m_signalquality))
+      m_scheduler->Schedule(m_signalquality, 0);
 
     XBMC->Log(LOG_INFO, "Live stream file: %s", filename.c_str());
     m_bTimeShiftStarted = true;
     m_iCurrentChannel = channelinfo.iUniqueId;
-    if (!m_keepalive->IsRunning())
-    {
-      if (!m_keepalive->CreateThread())
-      {
-        XBMC->Log(LOG_ERROR, "Start keepalive thread failed.");
-      }
-    }
+    // Tuning counts as alive for the server, the first keepalive is due one interval after it
+    m_scheduler->Schedule(m_keepalive, m_keepalive->FirstInterval());
 
 #if defined(ATV_DUMPTS)
     if (ofd != -1) close(ofd);
@@ -1273,10 +1265,17 @@ bool cPVRClientArgusTV::_OpenLiveStream(const PVR_CHANNEL &channelinfo)
     // TODO: rtsp support
     m_tsreader = new CTsReader();
     XBMC->Log(LOG_DEBUG, "Open TsReader");
-    m_tsreader->Open(filename.c_str());
+    m_tsreader->Open(filename.c_str(), g_bPrefetch);
+    m_zapstats.Mark(ZAP_OPEN);
+    m_zapstats.Move(ZAP_OPEN, ZAP_BUFFERWAIT, m_tsreader->GetOpenWaitTime());
     m_tsreader->OnZap();
-    XBMC->Log(LOG_DEBUG, "Delaying %ld milliseconds.", (g_iTuneDelay));
-    usleep(1000 * g_iTuneDelay);
+    m_zapstats.Mark(ZAP_ONZAP);
+    // Wait until the player can start decoding, instead of a fixed delay
+    int64_t readytime = GetTimeMs();
+    bool ready = m_tsreader->WaitUntilReady(g_iTuneDelay);
+    m_zapstats.Mark(ZAP_READY);
+    XBMC->Log(ready ? LOG_DEBUG : LOG_NOTICE, "Live stream %s after %d milliseconds (maximum %d).",
+      ready ? "ready" : "not ready", (int) (GetTimeMs() - readytime), g_iTuneDelay);
     return true;
   }
   else
@@ -1285,6 +1284,7 @@ bool cPVRClientArgusTV::_OpenLiveStream(const PVR_CHANNEL &channelinfo)
     XBMC->QueueNotification(QUEUE_ERROR, "XBMC Channel to GUID");
   }
 
+  m_zapstats.Abort("unknown channel");
   CloseLiveStream();
   return false;
 }
@@ -1302,7 +1302,7 @@ int cPVRClientArgusTV::ReadLiveStream(unsigned char* pBuffer, unsigned int iBuff
 {
   unsigned long read_wanted = iBufferSize;
   unsigned long read_done   = 0;
-  static int read_timeouts  = 0;
+  int64_t underrun_start    = 0;
   unsigned char* bufptr = pBuffer;
 
   // XBMC->Log(LOG_DEBUG, "->ReadLiveStream(buf_size=%i)", iBufferSize);
@@ -1316,34 +1316,39 @@ int cPVRClientArgusTV::ReadLiveStream(unsigned char* pBuffer, unsigned int iBuff
     long lRc = 0;
     if ((lRc = m_tsreader->Read(bufptr, read_wanted, &read_wanted)) > 0)
     {
-      usleep(400000);
-      read_timeouts++;
+      m_tsreader->WaitForData(iBufferSize, 400);
+      m_tsreader->Underrun(underrun_start ? GetTimeMs() - underrun_start : 0, true);
       XBMC->Log(LOG_NOTICE, "ReadLiveStream requested %d but only read %d bytes.", iBufferSize, read_wanted);
       return read_wanted;
     }
     read_done += read_wanted;
+    if (read_done > 0 && m_zapstats.IsRunning())
+      m_zapstats.FirstRead();
 
     if ( read_done < (unsigned long) iBufferSize )
     {
-      if (read_timeouts > 25)
+      // Caught up with the timeshift buffer, wait for it to grow
+      int64_t now = GetTimeMs();
+      if (underrun_start == 0)
+        underrun_start = now;
+      else if (now - underrun_start >= 1000)
       {
         XBMC->Log(LOG_INFO, "No data in 1 second");
-        read_timeouts = 0;
+        m_tsreader->Underrun(now - underrun_start, true);
         return read_done;
       }
       bufptr += read_wanted;
-      read_timeouts++;
-      usleep(40000);
+      m_tsreader->WaitForData(iBufferSize - read_done, (unsigned long) (1000 - (now - underrun_start)));
     }
   }
+  if (underrun_start)
+    m_tsreader->Underrun(GetTimeMs() - underrun_start, false);
 #if defined(ATV_DUMPTS)
   if (write(ofd, pBuffer, read_done) < 0)
   {
     XBMC->Log(LOG_ERROR, "couldn't write %d bytes to dumpfile %s (error %d: %s).", read_done, ofn, errno, strerror(errno));
   }
 #endif
-  // XBMC->Log(LOG_DEBUG, "ReadLiveStream(buf_size=%i), %d timeouts", iBufferSize, read_timeouts);
-  read_timeouts = 0;
   return read_done;
 }
 
@@ -1383,13 +1388,12 @@ void cPVRClientArgusTV::CloseLiveStream()
   string result;
   XBMC->Log(LOG_INFO, "CloseLiveStream");
 
-  if (m_keepalive->IsRunning())
-  {
-    if (!m_keepalive->StopThread())
-    {
-      XBMC->Log(LOG_ERROR, "Stop keepalive thread failed.");
-    }
-  } 
+  // Closed by Kodi before any data was read; a retune during a zap does not end the zap
+  if (m_iCurrentChannel != -1)
+    m_zapstats.Abort("closed");
+
+  m_scheduler->Cancel(m_keepalive);
+  m_scheduler->Cancel(m_signalquality);
 
 #if defined(ATV_DUMPTS)
   if (ofd != -1)
@@ -1442,51 +1446,12 @@ bool cPVRClientArgusTV::SwitchChannel(const PVR_CHANNEL &channelinfo)
 
 PVR_ERROR cPVRClientArgusTV::SignalStatus(PVR_SIGNAL_STATUS &signalStatus)
 {
-  static PVR_SIGNAL_STATUS tag;
-
-  // Only do the REST call once out of N
-  if (m_signalqualityInterval-- <= 0)
+  // Return the latest sample; Kodi asks while the info is shown, so sample in the background until it stops asking
+  m_signalquality->GetStatus(signalStatus);
+  if (m_bTimeShiftStarted && !m_scheduler->IsScheduled(m_signalquality))
   {
-    m_signalqualityInterval = SIGNALQUALITY_INTERVAL;
-    Json::Value response;
-    ArgusTV::SignalQuality(response);
-    memset(&tag, 0, sizeof(tag));
-    std::string cardtype = "";
-    switch (response["CardType"].asInt())
-    {
-    case 0x80:
-      cardtype = "Analog";
-      break;
-    case 8:
-      cardtype = "ATSC";
-      break;
-    case 4:
-      cardtype = "DVB-C";
-      break;
-    case 0x10:
-      cardtype = "DVB-IP";
-      break;
-    case 1:
-      cardtype = "DVB-S";
-      break;
-    case 2:
-      cardtype = "DVB-T";
-      break;
-    default:
-      cardtype = "Unknown card type";
-      break;
-    }
-    snprintf(tag.strAdapterName, 1024, "Provider %s, %s",
-      response["ProviderName"].asString().c_str(),
-      cardtype.c_str());
-    snprintf(tag.strAdapterStatus, 1024, "%s, %s",
-      response["Name"].asString().c_str(),
-      response["IsFreeToAir"].asBool() ? "free to air" : "encrypted");
-    tag.iSNR = (int) (response["SignalQuality"].asInt() * 655.35);
-    tag.iSignal = (int) (response["SignalStrength"].asInt() * 655.35);
+    m_scheduler->Schedule(m_signalquality, 0);
   }
-
-  signalStatus = tag;
   return PVR_ERROR_NO_ERROR;
 }
 
@@ -1505,7 +1470,7 @@ bool cPVRClientArgusTV::OpenRecordedStream(const PVR_RECORDING &recinfo)
     SAFE_DELETE(m_tsreader);
   }
   m_tsreader = new CTsReader();
-  if (m_tsreader->Open(UNCname.c_str()) != S_OK)
+  if (m_tsreader->Open(UNCname.c_str(), g_bPrefetch) != S_OK)
   {
     SAFE_DELETE(m_tsreader);
     return false;
@@ -1524,6 +1489,8 @@ void cPVRClientArgusTV::CloseRecordedStream(void)
     m_tsreader->Close();
     SAFE_DELETE(m_tsreader);
   }
+  // Kodi stores the resume position when playback stops
+  m_recordingupdates->FlushAsync();
 }
 
 int cPVRClientArgusTV::ReadRecordedStream(unsigned char* pBuffer, unsigned int iBuffersize)
@@ -28,8 +28,18 @@
 #include "recording.h"
 #include "guideprogram.h"
 
-#include "KeepAliveThread.h"
-#include "EventsThread.h"
+#include "Scheduler.h"
+#include "KeepAliveJob.h"
+#include "EventsJob.h"
+#include "SignalQualityJob.h"
+#include "epgcache.h"
+#include "recordingcache.h"
+#include "timercache.h"
+#include "zapstatistics.h"
+#include "RecordingUpdateJob.h"
+#include "RecordingDeleteJob.h"
+#include "EpgRevalidateJob.h"
+#include "JobPool.h"
 
 namespace ArgusTV
 {
@@ -60,6 +70,10 @@ public:
 
   /* EPG handling */
   PVR_ERROR GetEpg(ADDON_HANDLE handle, const PVR_CHANNEL &channel, time_t iStart, time_t iEnd);
+  PVR_ERROR SetEPGTimeFrame(int iDays);
+  void OnGuideDataChanged(void);
+  void OnRecordingChanged(const std::string& recordingid);
+  void OnTimersChanged(void);
 
   /* Channel handling */
   int GetNumChannels(void);
@@ -114,6 +128,7 @@ private:
   void FreeChannels(std::vector<cChannel*> m_Channels);
   void Close();
   bool _OpenLiveStream(const PVR_CHANNEL &channel);
+  std::string EpgCacheFile(void);
 
   int                     m_iCurrentChannel;
   bool                    m_bConnected;
@@ -129,10 +144,19 @@ private:
   std::vector<cChannel*>   m_TVChannels; // Local TV channel cache list needed for id to guid conversion
   std::vector<cChannel*>   m_RadioChannels; // Local Radio channel cache list needed for id to guid conversion
   int                     m_epg_id_offset;
-  int                     m_signalqualityInterval;
+  cEpgCache               m_epgcache;
+  CEpgRevalidateJob*      m_epgrevalidate;
+  cRecordingCache         m_recordingcache;
+  cTimerCache             m_timercache;
+  cZapStatistics          m_zapstats;
+  CRecordingUpdateJob*    m_recordingupdates;
+  CRecordingDeleteJob*    m_recordingdeletes;
+  CJobPool*               m_convertpool; // converts guide and recording data for Kodi
+  CSignalQualityJob*      m_signalquality;
   ArgusTV::CTsReader*     m_tsreader;
-  CKeepAliveThread*       m_keepalive;
-  CEventsThread*          m_eventmonitor;
+  CScheduler*             m_scheduler;
+  CKeepAliveJob*          m_keepalive;
+  CEventsJob*             m_eventmonitor;
 #if defined(ATV_DUMPTS)
   char ofn[25];
   int ofd;
@@ -110,4 +110,7 @@ public:
   double StarRating(void) const { return starrating; }
   const char *SubTitle(void) const { return subtitle.c_str(); }
   const char *Title(void) const { return title.c_str(); }
+
+  void SetLastWatchedPosition(int position) { lastwatchedposition = position; }
+  void SetFullyWatchedCount(int count) { fullywatchedcount = count; }
 };
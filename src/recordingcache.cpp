@@ -0,0 +1,354 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "client.h"
+#include "argustvrpc.h"
+#include "recordingcache.h"
+#include "recordinggroup.h"
+#include "JobPool.h"
+
+using namespace ADDON;
+using namespace P8PLATFORM;
+
+#define RECORDINGS_FETCH_THREADS 4
+
+namespace
+{
+  /**
+   * \brief Retrieves the recordings of one title group
+   */
+  class CTitleRecordingsJob : public CJob
+  {
+  public:
+    CTitleRecordingsJob(const std::string& title) : m_title(title), m_retval(E_FAILED) {}
+
+    virtual void Run(void)
+    {
+      m_retval = ArgusTV::GetFullRecordingsForTitle(m_title, m_response);
+    }
+
+    int Result(void) const { return m_retval; }
+    const Json::Value& Response(void) const { return m_response; }
+
+  private:
+    std::string m_title;
+    int m_retval;
+    Json::Value m_response;
+  };
+
+  void ParseRecordings(const Json::Value& response, std::vector<cRecording>& recordings)
+  {
+    int size = response.size();
+    for (int index = 0; index < size; ++index)
+    {
+      cRecording recording;
+      if (recording.Parse(response[index]))
+        recordings.push_back(recording);
+    }
+  }
+}
+
+cRecordingCache::cRecordingCache(void) :
+  m_bValid(false),
+  m_generation(0)
+{
+}
+
+cRecordingCache::~cRecordingCache(void)
+{
+}
+
+bool cRecordingCache::FetchAll(std::vector<cRecording>& recordings)
+{
+  recordings.clear();
+
+  // All recordings in one go
+  Json::Value response;
+  if (ArgusTV::GetFullRecordings(response) >= 0)
+  {
+    recordings.reserve(response.size());
+    ParseRecordings(response, recordings);
+    return true;
+  }
+
+  // Otherwise per title group, a few groups at a time
+  XBMC->Log(LOG_NOTICE, "Bulk retrieval of recordings failed, retrieving them per title.");
+  Json::Value recordinggroupresponse;
+  if (ArgusTV::GetRecordingGroupByTitle(recordinggroupresponse) < 0)
+    return false;
+
+  std::vector<CJob*> jobs;
+  int size = recordinggroupresponse.size();
+  for (int index = 0; index < size; ++index)
+  {
+    cRecordingGroup recordinggroup;
+    if (recordinggroup.Parse(recordinggroupresponse[index]))
+      jobs.push_back(new CTitleRecordingsJob(recordinggroup.ProgramTitle()));
+  }
+
+  CJobPool pool(RECORDINGS_FETCH_THREADS);
+  pool.Run(jobs);
+
+  for (std::vector<CJob*>::iterator it = jobs.begin(); it != jobs.end(); ++it)
+  {
+    CTitleRecordingsJob* job = static_cast<CTitleRecordingsJob*>(*it);
+    if (job->Result() >= 0)
+      ParseRecordings(job->Response(), recordings);
+    delete job;
+  }
+  return true;
+}
+
+bool cRecordingCache::FetchTitle(const std::string& title, std::vector<cRecording>& recordings)
+{
+  Json::Value response;
+  recordings.clear();
+  if (ArgusTV::GetFullRecordingsForTitle(title, response) < 0)
+    return false;
+  ParseRecordings(response, recordings);
+  return true;
+}
+
+bool cRecordingCache::Import(void)
+{
+  unsigned int generation;
+  {
+    CLockObject lock(m_mutex);
+    generation = m_generation;
+  }
+
+  std::vector<cRecording> recordings;
+  if (!FetchAll(recordings))
+    return false;
+
+  CLockObject lock(m_mutex);
+  m_recordings.clear();
+  m_filenames.clear();
+  for (std::vector<cRecording>::const_iterator it = recordings.begin(); it != recordings.end(); ++it)
+    Store(*it);
+  // A change reported during the import may not be part of it, the next request imports again
+  m_bValid = (generation == m_generation);
+  XBMC->Log(LOG_DEBUG, "cRecordingCache: imported %d recordings%s.", (int) m_recordings.size(),
+    m_bValid ? "" : ", changed meanwhile");
+  return true;
+}
+
+bool cRecordingCache::GetRecordings(std::vector<cRecording>& recordings)
+{
+  {
+    CLockObject lock(m_mutex);
+    if (!m_bValid)
+    {
+      lock.Unlock();
+      if (!Import())
+        return false;
+    }
+  }
+
+  CLockObject lock(m_mutex);
+  recordings.clear();
+  recordings.reserve(m_recordings.size());
+  for (std::map<std::string, cRecording>::const_iterator it = m_recordings.begin(); it != m_recordings.end(); ++it)
+    recordings.push_back(it->second);
+  return true;
+}
+
+int cRecordingCache::GetNumRecordings(void)
+{
+  {
+    CLockObject lock(m_mutex);
+    if (m_bValid)
+      return (int) m_recordings.size();
+  }
+  if (!Import())
+    return 0;
+
+  CLockObject lock(m_mutex);
+  return (int) m_recordings.size();
+}
+
+void cRecordingCache::UpdateRecording(const std::string& recordingid)
+{
+  std::string title;
+  {
+    CLockObject lock(m_mutex);
+    if (!m_bValid)
+    {
+      // The next request imports everything anyway, but one that is running may miss this change
+      m_generation++;
+      return;
+    }
+    std::map<std::string, cRecording>::const_iterator it = m_recordings.find(recordingid);
+    if (it != m_recordings.end())
+      title = it->second.Title();
+  }
+
+  Json::Value response;
+  cRecording recording;
+  if (ArgusTV::GetRecordingById(recordingid, response) >= 0 && recording.Parse(response))
+  {
+    CLockObject lock(m_mutex);
+    Store(recording);
+    XBMC->Log(LOG_DEBUG, "cRecordingCache: updated recording %s.", recordingid.c_str());
+    return;
+  }
+
+  std::vector<cRecording> recordings;
+  if (!title.empty() && FetchTitle(title, recordings))
+  {
+    CLockObject lock(m_mutex);
+    std::map<std::string, cRecording>::iterator it = m_recordings.begin();
+    while (it != m_recordings.end())
+    {
+      if (title == it->second.Title())
+        Erase(it++);
+      else
+        ++it;
+    }
+    for (std::vector<cRecording>::const_iterator rec = recordings.begin(); rec != recordings.end(); ++rec)
+      Store(*rec);
+    XBMC->Log(LOG_DEBUG, "cRecordingCache: updated %d recordings of \"%s\".", (int) recordings.size(), title.c_str());
+    return;
+  }
+
+  XBMC->Log(LOG_DEBUG, "cRecordingCache: recording %s could not be updated, a full import follows.", recordingid.c_str());
+  Invalidate();
+}
+
+bool cRecordingCache::RemoveRecording(const std::string& recordingid, cRecording* removed)
+{
+  CLockObject lock(m_mutex);
+  m_deleting.insert(recordingid);
+  std::map<std::string, cRecording>::iterator it = m_recordings.find(recordingid);
+  if (it == m_recordings.end())
+    return false;
+  if (removed)
+    *removed = it->second;
+  Erase(it);
+  return true;
+}
+
+void cRecordingCache::DeleteDone(const std::string& recordingid, bool success, const cRecording* removed)
+{
+  CLockObject lock(m_mutex);
+  m_deleting.erase(recordingid);
+  if (!success && removed && m_bValid)
+    Store(*removed);
+}
+
+void cRecordingCache::Invalidate(void)
+{
+  CLockObject lock(m_mutex);
+  m_recordings.clear();
+  m_filenames.clear();
+  m_bValid = false;
+  m_generation++;
+}
+
+void cRecordingCache::Store(const cRecording& recording)
+{
+  if (m_deleting.find(recording.RecordingId()) != m_deleting.end())
+    return;
+
+  std::map<std::string, cRecording>::iterator it = m_recordings.find(recording.RecordingId());
+  if (it != m_recordings.end())
+    m_filenames.erase(it->second.RecordingFileName());
+  cRecording& stored = m_recordings[recording.RecordingId()];
+  stored = recording;
+  m_filenames[recording.RecordingFileName()] = recording.RecordingId();
+
+  // The server does not know the queued watched state yet
+  std::map<std::string, Written>::const_iterator written = m_written.find(recording.RecordingFileName());
+  if (written != m_written.end())
+  {
+    if (written->second.hasPosition)
+      stored.SetLastWatchedPosition(written->second.position);
+    if (written->second.hasPlaycount)
+      stored.SetFullyWatchedCount(written->second.playcount);
+  }
+}
+
+void cRecordingCache::Erase(std::map<std::string, cRecording>::iterator it)
+{
+  m_filenames.erase(it->second.RecordingFileName());
+  m_recordings.erase(it);
+}
+
+cRecording* cRecordingCache::Find(const std::string& recordingid, const std::string& filename)
+{
+  std::map<std::string, cRecording>::iterator it = m_recordings.find(recordingid);
+  if (it == m_recordings.end())
+  {
+    std::map<std::string, std::string>::const_iterator name = m_filenames.find(filename);
+    if (name != m_filenames.end())
+      it = m_recordings.find(name->second);
+  }
+  return (it != m_recordings.end()) ? &it->second : NULL;
+}
+
+bool cRecordingCache::GetResumeInfo(const std::string& recordingid, const std::string& filename, int& position, int& playcount)
+{
+  CLockObject lock(m_mutex);
+  cRecording* recording = Find(recordingid, filename);
+  if (recording == NULL)
+    return false;
+  position = recording->LastWatchedPosition();
+  playcount = recording->FullyWatchedCount();
+  return true;
+}
+
+void cRecordingCache::SetLastWatchedPosition(const std::string& recordingid, const std::string& filename, int position)
+{
+  CLockObject lock(m_mutex);
+  Written& written = m_written[filename];
+  written.hasPosition = true;
+  written.position = position;
+  cRecording* recording = Find(recordingid, filename);
+  if (recording)
+    recording->SetLastWatchedPosition(position);
+}
+
+void cRecordingCache::SetFullyWatchedCount(const std::string& recordingid, const std::string& filename, int playcount)
+{
+  CLockObject lock(m_mutex);
+  Written& written = m_written[filename];
+  written.hasPlaycount = true;
+  written.playcount = playcount;
+  cRecording* recording = Find(recordingid, filename);
+  if (recording)
+    recording->SetFullyWatchedCount(playcount);
+}
+
+void cRecordingCache::WriteDone(const std::string& filename, const int* position, const int* playcount)
+{
+  CLockObject lock(m_mutex);
+  std::map<std::string, Written>::iterator it = m_written.find(filename);
+  if (it == m_written.end())
+    return;
+
+  // A value that changed again after this write is still queued
+  if (position && it->second.hasPosition && it->second.position == *position)
+    it->second.hasPosition = false;
+  if (playcount && it->second.hasPlaycount && it->second.playcount == *playcount)
+    it->second.hasPlaycount = false;
+  if (!it->second.hasPosition && !it->second.hasPlaycount)
+    m_written.erase(it);
+}
@@ -0,0 +1,120 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "p8-platform/threads/mutex.h"
+#include "recording.h"
+
+/**
+ * \brief Local copy of the recordings on the server, keyed by RecordingId.
+ *        It is imported once and then kept up to date with targeted updates for the
+ *        recordings that the server reports as changed.
+ */
+class cRecordingCache
+{
+public:
+  cRecordingCache(void);
+  virtual ~cRecordingCache(void);
+
+  /**
+   * \brief Copy all recordings, importing them from the server first when needed
+   * \return false when the recordings could not be retrieved
+   */
+  bool GetRecordings(std::vector<cRecording>& recordings);
+
+  /**
+   * \brief The number of recordings, importing them from the server first when needed
+   */
+  int GetNumRecordings(void);
+
+  /**
+   * \brief Refetch one recording, falling back to the recordings of its title
+   *        and to a complete import when that fails
+   */
+  void UpdateRecording(const std::string& recordingid);
+
+  /**
+   * \brief Remove a recording that is being deleted on the server. Until DeleteDone() is called
+   *        it stays hidden, even when the server still reports it.
+   * \param removed Receives the removed recording, when it was in the cache
+   * \return true when the recording was in the cache
+   */
+  bool RemoveRecording(const std::string& recordingid, cRecording* removed = NULL);
+
+  /**
+   * \brief Finish a deletion started with RemoveRecording(); a failed deletion restores the recording
+   */
+  void DeleteDone(const std::string& recordingid, bool success, const cRecording* removed);
+
+  /**
+   * \brief Look up the resume position (seconds) and play count of a recording by id or, when the id
+   *        is unknown, by file name (the stream URL handed to Kodi)
+   * \return false when the recording is not in the cache
+   */
+  bool GetResumeInfo(const std::string& recordingid, const std::string& filename, int& position, int& playcount);
+
+  /**
+   * \brief Record a resume position or play count that is being written to the server. Until
+   *        WriteDone() it is laid over the recording again when the server still reports the old value.
+   */
+  void SetLastWatchedPosition(const std::string& recordingid, const std::string& filename, int position);
+  void SetFullyWatchedCount(const std::string& recordingid, const std::string& filename, int playcount);
+
+  /**
+   * \brief A resume position and/or play count (NULL when not part of the write) reached the server or was given up
+   */
+  void WriteDone(const std::string& filename, const int* position, const int* playcount);
+
+  /**
+   * \brief Forget everything, the next request imports all recordings again
+   */
+  void Invalidate(void);
+
+private:
+  bool Import(void);
+  static bool FetchAll(std::vector<cRecording>& recordings);
+  static bool FetchTitle(const std::string& title, std::vector<cRecording>& recordings);
+  void Store(const cRecording& recording);
+  void Erase(std::map<std::string, cRecording>::iterator it);
+  cRecording* Find(const std::string& recordingid, const std::string& filename);
+
+  struct Written
+  {
+    bool hasPosition;
+    int position;
+    bool hasPlaycount;
+    int playcount;
+
+    Written(void) : hasPosition(false), position(0), hasPlaycount(false), playcount(0) {}
+  };
+
+  P8PLATFORM::CMutex m_mutex;
+  std::map<std::string, cRecording> m_recordings;
+  std::map<std::string, std::string> m_filenames; // file name -> RecordingId
+  std::set<std::string> m_deleting;               // RecordingIds with a pending deletion
+  std::map<std::string, Written> m_written;       // file name -> watched state still queued for the server
+  bool m_bValid;
+  unsigned int m_generation;                      // incremented by Invalidate()
+};
@@ -0,0 +1,115 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stringpool.h"
+
+const uint32_t cStringPool::PROBE;
+
+cStringPool::cStringPool(void) :
+  m_index(64, Hash(this), Equal(this)),
+  m_probe(NULL),
+  m_bytes(0)
+{
+  Clear();
+}
+
+cStringPool::~cStringPool(void)
+{
+}
+
+uint32_t cStringPool::Add(const std::string& str)
+{
+  if (str.empty())
+    return 0;
+
+  m_probe = &str;
+  std::unordered_set<uint32_t, Hash, Equal>::const_iterator it = m_index.find(PROBE);
+  m_probe = NULL;
+  if (it != m_index.end())
+  {
+    m_refcounts[*it]++;
+    return *it;
+  }
+
+  uint32_t id;
+  if (!m_free.empty())
+  {
+    id = m_free.back();
+    m_free.pop_back();
+    m_strings[id] = str;
+    m_refcounts[id] = 1;
+  }
+  else
+  {
+    id = (uint32_t) m_strings.size();
+    m_strings.push_back(str);
+    m_refcounts.push_back(1);
+  }
+  m_bytes += m_strings[id].capacity();
+  m_index.insert(id);
+  return id;
+}
+
+void cStringPool::AddRef(uint32_t id)
+{
+  if (id != 0 && id < m_strings.size() && m_refcounts[id] != 0)
+    m_refcounts[id]++;
+}
+
+void cStringPool::Release(uint32_t id)
+{
+  if (id == 0 || id >= m_strings.size() || m_refcounts[id] == 0)
+    return;
+
+  if (--m_refcounts[id] == 0)
+  {
+    m_index.erase(id);
+    m_bytes -= m_strings[id].capacity();
+    std::string().swap(m_strings[id]);
+    m_free.push_back(id);
+  }
+}
+
+const std::string& cStringPool::Get(uint32_t id) const
+{
+  return (id < m_strings.size()) ? m_strings[id] : m_strings[0];
+}
+
+size_t cStringPool::MemoryUsage(void) const
+{
+  return m_bytes
+    + m_strings.capacity() * sizeof(std::string)
+    + m_refcounts.capacity() * sizeof(uint32_t)
+    + m_free.capacity() * sizeof(uint32_t)
+    + m_index.bucket_count() * sizeof(void*) + m_index.size() * (sizeof(uint32_t) + 2 * sizeof(void*));
+}
+
+void cStringPool::Clear(void)
+{
+  m_index.clear();
+  m_strings.clear();
+  m_refcounts.clear();
+  m_free.clear();
+  // id 0: the empty string
+  m_strings.push_back(std::string());
+  m_refcounts.push_back(0);
+  m_bytes = 0;
+}
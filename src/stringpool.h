@@ -0,0 +1,89 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+/**
+ * \brief Reference counted pool of interned strings. Equal strings are stored once and
+ *        referred to by a 32 bit id. Id 0 is reserved for the empty string and is not counted.
+ *        The pool is not thread safe, the owner must serialize access.
+ */
+class cStringPool
+{
+public:
+  cStringPool(void);
+  virtual ~cStringPool(void);
+
+  /**
+   * \brief Add a reference to a string, storing it when it is not yet in the pool
+   * \return The id of the string
+   */
+  uint32_t Add(const std::string& str);
+
+  /**
+   * \brief Add a reference to a string that is already in the pool
+   */
+  void AddRef(uint32_t id);
+
+  /**
+   * \brief Drop a reference obtained by Add(); the string is freed with its last reference
+   */
+  void Release(uint32_t id);
+
+  const std::string& Get(uint32_t id) const;
+  size_t Count(void) const { return m_index.size(); }
+  uint32_t IdCount(void) const { return (uint32_t) m_strings.size(); } ///< all ids are below this value
+  size_t MemoryUsage(void) const;
+  void Clear(void);
+
+private:
+  cStringPool(const cStringPool&);
+  cStringPool& operator=(const cStringPool&);
+
+  static const uint32_t PROBE = 0xFFFFFFFF; // id used to look up a string that is not (yet) in the pool
+
+  struct Hash
+  {
+    const cStringPool* pool;
+    Hash(const cStringPool* p) : pool(p) {}
+    size_t operator()(uint32_t id) const { return std::hash<std::string>()(pool->Lookup(id)); }
+  };
+
+  struct Equal
+  {
+    const cStringPool* pool;
+    Equal(const cStringPool* p) : pool(p) {}
+    bool operator()(uint32_t a, uint32_t b) const { return pool->Lookup(a) == pool->Lookup(b); }
+  };
+
+  const std::string& Lookup(uint32_t id) const { return (id == PROBE) ? *m_probe : m_strings[id]; }
+
+  std::vector<std::string> m_strings;
+  std::vector<uint32_t> m_refcounts;
+  std::vector<uint32_t> m_free;
+  std::unordered_set<uint32_t, Hash, Equal> m_index;
+  const std::string* m_probe;
+  size_t m_bytes;
+};
@@ -0,0 +1,165 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "client.h"
+#include "argustvrpc.h"
+#include "activerecording.h"
+#include "timercache.h"
+
+using namespace ADDON;
+using namespace P8PLATFORM;
+
+cTimerCache::cTimerCache(void) :
+  m_bValid(false),
+  m_generation(0),
+  m_expires(0)
+{
+}
+
+cTimerCache::~cTimerCache(void)
+{
+}
+
+bool cTimerCache::Import(void)
+{
+  unsigned int generation;
+  {
+    CLockObject lock(m_mutex);
+    generation = m_generation;
+  }
+
+  Json::Value activeRecordingsResponse, upcomingRecordingsResponse;
+
+  // retrieve the currently active recordings
+  if (ArgusTV::GetActiveRecordings(activeRecordingsResponse) < 0)
+  {
+    XBMC->Log(LOG_ERROR, "Unable to retrieve active recordings from server.");
+    return false;
+  }
+
+  // pick up the upcoming recordings
+  if (ArgusTV::GetUpcomingRecordings(upcomingRecordingsResponse) < 0)
+  {
+    XBMC->Log(LOG_ERROR, "Unable to retrieve upcoming programs from server.");
+    return false;
+  }
+
+  // Parse the active recordings once, indexed by UpcomingProgramId
+  std::unordered_map<std::string, Json::Value::UInt> activerecordings;
+  for (Json::Value::UInt j = 0; j < activeRecordingsResponse.size(); j++)
+  {
+    cActiveRecording activerecording;
+    if (activerecording.Parse(activeRecordingsResponse[j]))
+      activerecordings.insert(std::make_pair(activerecording.UpcomingProgramId(), j));
+  }
+
+  // Upcoming recordings beyond the horizon are skipped before they are parsed
+  time_t horizon = g_iUpcomingDays > 0 ? time(NULL) + g_iUpcomingDays * 24 * 60 * 60 : 0;
+  time_t firstSkipped = 0;
+  int skipped = 0;
+
+  std::vector<Timer> timers;
+  timers.reserve(upcomingRecordingsResponse.size());
+  for (Json::Value::UInt i = 0; i < upcomingRecordingsResponse.size(); i++)
+  {
+    if (horizon != 0 && upcomingRecordingsResponse[i].isObject())
+    {
+      int offset;
+      const Json::Value& programobject = upcomingRecordingsResponse[i]["Program"];
+      time_t starttime = programobject.isObject() ? ArgusTV::WCFDateToTimeT(programobject["StartTime"].asString(), offset) : 0;
+      if (starttime > horizon)
+      {
+        if (firstSkipped == 0 || starttime < firstSkipped)
+          firstSkipped = starttime;
+        skipped++;
+        continue;
+      }
+    }
+
+    Timer timer;
+    if (!timer.upcoming.Parse(upcomingRecordingsResponse[i]))
+      continue;
+    std::unordered_map<std::string, Json::Value::UInt>::const_iterator active = activerecordings.find(timer.upcoming.UpcomingProgramId());
+    if (active != activerecordings.end())
+      timer.activerecording = activeRecordingsResponse[active->second];
+    timers.push_back(timer);
+  }
+
+  CLockObject lock(m_mutex);
+  m_timers.swap(timers);
+  m_index.clear();
+  for (size_t i = 0; i < m_timers.size(); i++)
+    m_index[m_timers[i].upcoming.ID()] = i;
+  // A change reported during the import may not be part of it
+  m_bValid = (generation == m_generation);
+  m_expires = firstSkipped != 0 ? firstSkipped - g_iUpcomingDays * 24 * 60 * 60 : 0;
+  XBMC->Log(LOG_DEBUG, "cTimerCache: imported %d timers, skipped %d beyond %d days.", (int) m_timers.size(), skipped, g_iUpcomingDays);
+  return true;
+}
+
+bool cTimerCache::EnsureValid(void)
+{
+  {
+    CLockObject lock(m_mutex);
+    if (m_bValid && (m_expires == 0 || time(NULL) < m_expires))
+      return true;
+  }
+  return Import();
+}
+
+bool cTimerCache::GetTimers(std::vector<Timer>& timers)
+{
+  if (!EnsureValid())
+    return false;
+
+  CLockObject lock(m_mutex);
+  timers = m_timers;
+  return true;
+}
+
+int cTimerCache::GetNumTimers(void)
+{
+  if (!EnsureValid())
+    return 0;
+
+  CLockObject lock(m_mutex);
+  return (int) m_timers.size();
+}
+
+bool cTimerCache::FindTimer(int clientindex, Timer& timer)
+{
+  if (!EnsureValid())
+    return false;
+
+  CLockObject lock(m_mutex);
+  std::unordered_map<int, size_t>::const_iterator it = m_index.find(clientindex);
+  if (it == m_index.end())
+    return false;
+  timer = m_timers[it->second];
+  return true;
+}
+
+void cTimerCache::Invalidate(void)
+{
+  CLockObject lock(m_mutex);
+  m_bValid = false;
+  m_generation++;
+}
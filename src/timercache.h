@@ -0,0 +1,83 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <json/json.h>
+#include "p8-platform/threads/mutex.h"
+#include "upcomingrecording.h"
+
+/**
+ * \brief Local copy of the upcoming recordings on the server, joined with the active recordings.
+ *        It is imported on first use and rebuilt after Invalidate(), which is called when the
+ *        server reports changed upcoming recordings or a recording that started or ended.
+ *        Only upcoming recordings that start within g_iUpcomingDays days are kept; the cache is
+ *        rebuilt when the first of the skipped recordings moves into that window.
+ */
+class cTimerCache
+{
+public:
+  struct Timer
+  {
+    cUpcomingRecording upcoming;
+    Json::Value activerecording; ///< the active recording when it is recording now, null otherwise
+
+    bool IsRecording(void) const { return !activerecording.isNull(); }
+  };
+
+  cTimerCache(void);
+  virtual ~cTimerCache(void);
+
+  /**
+   * \brief Copy all timers in server order, importing them from the server first when needed
+   * \return false when the timers could not be retrieved
+   */
+  bool GetTimers(std::vector<Timer>& timers);
+
+  /**
+   * \brief The number of timers, importing them from the server first when needed
+   */
+  int GetNumTimers(void);
+
+  /**
+   * \brief Look up a timer by its Kodi client index (the upcoming recording id)
+   * \return false when there is no such timer or the timers could not be retrieved
+   */
+  bool FindTimer(int clientindex, Timer& timer);
+
+  /**
+   * \brief Forget everything, the next request imports the timers again
+   */
+  void Invalidate(void);
+
+private:
+  bool Import(void);
+  bool EnsureValid(void);
+
+  P8PLATFORM::CMutex m_mutex;
+  std::vector<Timer> m_timers;                   // in server order
+  std::unordered_map<int, size_t> m_index;       // upcoming recording id -> position in m_timers
+  bool m_bValid;
+  unsigned int m_generation;                     // incremented by Invalidate()
+  time_t m_expires;                              // the first skipped timer enters the window, 0 when none was skipped
+};
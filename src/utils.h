@@ -45,6 +45,19 @@ std::string ToCIFS(std::string& UNCName);
 std::string ToUNC(std::string& CIFSName);
 std::string ToUNC(const char* CIFSName);
 
+/**
+ * \brief The "localpaths" setting: local mount points of the server shares, "\\server\share=/local/path;...".
+ *        Changed by Kodi while streams are opened on other threads, so it is only used through these.
+ */
+void SetLocalPaths(const std::string& localpaths);
+std::string GetLocalPaths(void);
+
+/**
+ * \brief Translate a UNC name or smb:// URL into a local path with the "localpaths" setting
+ * \return false when the share has no local path
+ */
+bool ToLocalPath(const std::string& name, std::string& localname);
+
 #if defined(TARGET_WINDOWS)
 namespace UTF8Util
 {
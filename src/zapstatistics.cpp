@@ -0,0 +1,157 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <algorithm>
+#include "client.h"
+#include "zapstatistics.h"
+#include "p8-platform/util/timeutils.h"
+
+using namespace ADDON;
+using namespace P8PLATFORM;
+
+// Number of zaps in the rolling histograms
+#define ZAP_HISTORY 64
+// Histogram buckets: < 10 ms, < 20 ms, < 50 ms, ... , >= 10 s
+static const int64_t g_zapBuckets[] = { 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000 };
+#define ZAP_BUCKETS (sizeof(g_zapBuckets) / sizeof(g_zapBuckets[0]) + 1)
+
+static const char* g_zapPhaseNames[ZAP_PHASES] =
+  { "channel", "tune", "retune", "cifs", "open", "bufferwait", "onzap", "ready", "firstread", "total" };
+
+cZapStatistics::cZapStatistics(void) :
+  m_bRunning(false),
+  m_channel(0),
+  m_zaps(0),
+  m_start(0),
+  m_last(0),
+  m_next(0)
+{
+  for (int i = 0; i < ZAP_PHASES; i++)
+    m_current[i] = 0;
+}
+
+void cZapStatistics::Start(unsigned int channel)
+{
+  Finish("replaced"); // the previous zap never delivered data
+
+  CLockObject lock(m_mutex);
+  m_bRunning = true;
+  m_channel = channel;
+  m_start = m_last = GetTimeMs();
+  for (int i = 0; i < ZAP_PHASES; i++)
+    m_current[i] = -1; // phase did not occur
+}
+
+void cZapStatistics::Mark(eZapPhase phase)
+{
+  CLockObject lock(m_mutex);
+  if (!m_bRunning)
+    return;
+  int64_t now = GetTimeMs();
+  m_current[phase] = std::max(m_current[phase], (int64_t) 0) + (now - m_last);
+  m_last = now;
+}
+
+void cZapStatistics::Move(eZapPhase from, eZapPhase to, int64_t ms)
+{
+  CLockObject lock(m_mutex);
+  if (!m_bRunning || ms <= 0 || m_current[from] < 0)
+    return;
+  ms = std::min(ms, m_current[from]);
+  m_current[from] -= ms;
+  m_current[to] = std::max(m_current[to], (int64_t) 0) + ms;
+}
+
+void cZapStatistics::FirstRead(void)
+{
+  Mark(ZAP_FIRSTREAD);
+  Finish("ok");
+}
+
+void cZapStatistics::Abort(const char* reason)
+{
+  Finish(reason);
+}
+
+void cZapStatistics::Finish(const char* outcome)
+{
+  CLockObject lock(m_mutex);
+  if (!m_bRunning)
+    return;
+  m_bRunning = false;
+  m_current[ZAP_TOTAL] = GetTimeMs() - m_start;
+  m_zaps++;
+
+  std::string line;
+  char buffer[64];
+  for (int i = 0; i < ZAP_PHASES; i++)
+  {
+    if (m_history[i].size() < ZAP_HISTORY)
+      m_history[i].resize(ZAP_HISTORY, -1);
+    m_history[i][m_next] = m_current[i];
+
+    if (m_current[i] < 0)
+      continue;
+    snprintf(buffer, sizeof(buffer), "%s%s %d", line.empty() ? "" : ", ", g_zapPhaseNames[i], (int) m_current[i]);
+    line += buffer;
+  }
+  m_next = (m_next + 1) % ZAP_HISTORY;
+
+  XBMC->Log(LOG_INFO, "Zap %u to channel %u (%s), ms: %s.", m_zaps, m_channel, outcome, line.c_str());
+}
+
+void cZapStatistics::LogHistograms(void)
+{
+  CLockObject lock(m_mutex);
+  if (m_zaps == 0)
+    return;
+
+  XBMC->Log(LOG_INFO, "Zap phase histograms over the last %u zaps, buckets <10|<20|<50|<100|<200|<500|<1000|<2000|<5000|<10000|more ms:",
+    std::min(m_zaps, (unsigned int) ZAP_HISTORY));
+  for (int i = 0; i < ZAP_PHASES; i++)
+  {
+    unsigned int counts[ZAP_BUCKETS] = { 0 };
+    std::vector<int64_t> samples;
+    for (std::vector<int64_t>::const_iterator it = m_history[i].begin(); it != m_history[i].end(); ++it)
+    {
+      if (*it < 0)
+        continue;
+      samples.push_back(*it);
+      size_t bucket = 0;
+      while (bucket < ZAP_BUCKETS - 1 && *it >= g_zapBuckets[bucket])
+        bucket++;
+      counts[bucket]++;
+    }
+    if (samples.empty())
+      continue;
+    std::sort(samples.begin(), samples.end());
+
+    std::string line;
+    char buffer[16];
+    for (size_t bucket = 0; bucket < ZAP_BUCKETS; bucket++)
+    {
+      snprintf(buffer, sizeof(buffer), "%s%u", bucket ? "|" : "", counts[bucket]);
+      line += buffer;
+    }
+    XBMC->Log(LOG_INFO, "  %-10s %s (median %d, p90 %d ms)", g_zapPhaseNames[i], line.c_str(),
+      (int) samples[samples.size() / 2], (int) samples[(samples.size() * 9) / 10]);
+  }
+}
@@ -0,0 +1,96 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include "p8-platform/threads/mutex.h"
+
+/**
+ * \brief Phases of a channel switch, in the order in which they happen
+ */
+enum eZapPhase
+{
+  ZAP_FETCHCHANNEL,  ///< map the Kodi channel to the ARGUS TV channel
+  ZAP_TUNE,          ///< TuneLiveStream RPC
+  ZAP_RETUNE,        ///< closing the running stream and tuning again after NoReTunePossible
+  ZAP_TOCIFS,        ///< translating the buffer file name
+  ZAP_OPEN,          ///< CTsReader::Open, without the waits for the buffer file
+  ZAP_BUFFERWAIT,    ///< waits for the buffer file to get contents (RefreshTSBufferFile retries)
+  ZAP_ONZAP,         ///< positioning at the live edge
+  ZAP_READY,         ///< waiting for a decodable stream (the tune delay)
+  ZAP_FIRSTREAD,     ///< from returning to Kodi until the first non-empty read
+  ZAP_TOTAL,
+  ZAP_PHASES
+};
+
+/**
+ * \brief Time spent in each phase of the channel switches. Every zap is logged in one line;
+ *        per phase a histogram over the last ZAP_HISTORY zaps is kept.
+ */
+class cZapStatistics
+{
+public:
+  cZapStatistics(void);
+
+  /**
+   * \brief Start timing a channel switch; the phases are measured from here
+   */
+  void Start(unsigned int channel);
+
+  /**
+   * \brief End the running phase: the time since the previous mark goes to the given phase
+   */
+  void Mark(eZapPhase phase);
+
+  /**
+   * \brief Move time that was measured as part of one phase to another one
+   */
+  void Move(eZapPhase from, eZapPhase to, int64_t ms);
+
+  /**
+   * \brief The player received data (ends the zap) or the zap failed or was abandoned
+   */
+  void FirstRead(void);
+  void Abort(const char* reason);
+
+  bool IsRunning(void) const { return m_bRunning; }
+
+  /**
+   * \brief Log a histogram line per phase
+   */
+  void LogHistograms(void);
+
+private:
+  void Finish(const char* outcome);
+
+  P8PLATFORM::CMutex m_mutex;
+  std::atomic<bool> m_bRunning;
+  unsigned int m_channel;
+  unsigned int m_zaps;
+  int64_t      m_start;
+  int64_t      m_last;
+  int64_t      m_current[ZAP_PHASES];
+  std::vector<int64_t> m_history[ZAP_PHASES]; // ring of the last ZAP_HISTORY durations
+  size_t       m_next;                        // next slot in the rings
+};
@@ -0,0 +1,35 @@
+#!/bin/sh
+# Compares the file backends on a share with slow reads, emulated by slowfs.
+#
+# usage: run.sh <directory of slowfs and tsreader-bench> <backing file> [MB]
+#
+# Needs root for the FUSE mount. The backing file should be a few hundred MB of transport
+# stream. With direct io every read goes to the server (a share without page cache); without
+# it the kernel caches and reads ahead, which is where a mapping gets its pages from; a
+# direct io file can not be mapped at all.
+
+set -e
+
+BIN=$1
+BACKING=$2
+SIZE=${3:-128}
+if [ -z "$BIN" ] || [ -z "$BACKING" ]; then
+  echo "usage: $0 <directory of slowfs and tsreader-bench> <backing file> [MB]" >&2
+  exit 2
+fi
+
+MOUNT=$(mktemp -d)
+trap 'umount "$MOUNT" 2>/dev/null || true; rmdir "$MOUNT"' EXIT
+
+for direct in 1 0; do
+  for latency in 2000 10000; do
+    for backend in blocking uring mmap; do
+      "$BIN/slowfs" "$MOUNT" "$BACKING" $latency $direct 8 &
+      sleep 0.5
+      printf "direct=%s latency=%5dus " $direct $latency
+      "$BIN/tsreader-bench" $backend "$MOUNT/data.ts" $SIZE || true
+      umount "$MOUNT"
+      wait
+    done
+  done
+done
@@ -0,0 +1,264 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+/*
+ * Minimal read-only FUSE server, without libfuse: it exposes one backing file as data.ts and
+ * delays every READ request, so the file backends can be compared on a slow share.
+ *
+ * usage: slowfs <mount point> <backing file> <latency us> <direct io 0|1> <threads>
+ *
+ * Mounting needs CAP_SYS_ADMIN. The server exits when the mount point is unmounted and prints
+ * the number and size of the reads it served and how many were in flight at most.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/fuse.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mount.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define MAX_THREADS 64
+#define MAX_READ (2 * 1024 * 1024)
+
+static int g_dev;
+static int g_backing;
+static int g_latency;
+static int g_direct;
+static struct stat g_backingStat;
+
+/* statistics */
+static int g_inFlight;
+static int g_maxInFlight;
+static int g_reads;
+static long long g_bytes;
+
+static void PrintStatistics(void)
+{
+  fprintf(stderr, "  [server: %d reads, avg %lld KB, max %d in flight]\n",
+    g_reads, g_reads ? g_bytes / g_reads / 1024 : 0, g_maxInFlight);
+}
+
+static void Reply(uint64_t unique, int error, const void* data, size_t length)
+{
+  struct fuse_out_header header;
+  struct iovec iov[2];
+
+  if (error)
+    length = 0;
+  header.len = sizeof(header) + length;
+  header.error = error;
+  header.unique = unique;
+  iov[0].iov_base = &header;
+  iov[0].iov_len = sizeof(header);
+  iov[1].iov_base = (void*) data;
+  iov[1].iov_len = length;
+  if (writev(g_dev, iov, 2) < 0 && errno != ENOENT)
+    perror("slowfs: reply");
+}
+
+static void FillAttributes(struct fuse_attr* attr, uint64_t node)
+{
+  memset(attr, 0, sizeof(*attr));
+  attr->ino = node;
+  attr->blksize = 4096;
+  if (node == FUSE_ROOT_ID)
+  {
+    attr->mode = S_IFDIR | 0755;
+    attr->nlink = 2;
+  }
+  else
+  {
+    attr->mode = S_IFREG | 0444;
+    attr->nlink = 1;
+    attr->size = g_backingStat.st_size;
+    attr->blocks = (g_backingStat.st_size + 511) / 512;
+  }
+}
+
+static void Read(uint64_t unique, const struct fuse_read_in* request, char* out)
+{
+  int inFlight = __atomic_add_fetch(&g_inFlight, 1, __ATOMIC_SEQ_CST);
+  if (inFlight > g_maxInFlight)
+    g_maxInFlight = inFlight;
+  __atomic_add_fetch(&g_reads, 1, __ATOMIC_SEQ_CST);
+  __atomic_add_fetch(&g_bytes, request->size, __ATOMIC_SEQ_CST);
+
+  usleep(g_latency);
+  __atomic_sub_fetch(&g_inFlight, 1, __ATOMIC_SEQ_CST);
+
+  size_t size = request->size < MAX_READ ? request->size : MAX_READ;
+  ssize_t got = pread(g_backing, out, size, request->offset);
+  Reply(unique, got < 0 ? -errno : 0, out, got < 0 ? 0 : (size_t) got);
+}
+
+static void* Worker(void* arg)
+{
+  size_t size = FUSE_MIN_READ_BUFFER + MAX_READ;
+  char* buffer = malloc(size);
+  char* out = malloc(MAX_READ);
+  (void) arg;
+
+  for (;;)
+  {
+    ssize_t n = read(g_dev, buffer, size);
+    if (n < 0)
+    {
+      if (errno == EINTR || errno == EAGAIN || errno == ENOENT)
+        continue;
+      if (errno == ENODEV)
+      {
+        PrintStatistics();
+        exit(0);
+      }
+      perror("slowfs: read");
+      exit(1);
+    }
+
+    struct fuse_in_header* in = (struct fuse_in_header*) buffer;
+    void* body = buffer + sizeof(*in);
+    switch (in->opcode)
+    {
+    case FUSE_INIT:
+      {
+        struct fuse_init_in* init = body;
+        struct fuse_init_out reply;
+        memset(&reply, 0, sizeof(reply));
+        reply.major = FUSE_KERNEL_VERSION;
+        reply.minor = init->minor < 31 ? init->minor : 31;
+        reply.max_readahead = init->max_readahead;
+        reply.flags = FUSE_ASYNC_READ | FUSE_MAX_PAGES | FUSE_BIG_WRITES;
+        reply.max_background = 64;
+        reply.congestion_threshold = 48;
+        reply.max_write = 1024 * 1024;
+        reply.max_pages = MAX_READ / 4096 / 2;
+        Reply(in->unique, 0, &reply, sizeof(reply));
+        break;
+      }
+    case FUSE_LOOKUP:
+      {
+        struct fuse_entry_out reply;
+        if (in->nodeid != FUSE_ROOT_ID || strcmp((const char*) body, "data.ts") != 0)
+        {
+          Reply(in->unique, -ENOENT, NULL, 0);
+          break;
+        }
+        memset(&reply, 0, sizeof(reply));
+        reply.nodeid = 2;
+        reply.attr_valid = 1;
+        FillAttributes(&reply.attr, 2);
+        Reply(in->unique, 0, &reply, sizeof(reply));
+        break;
+      }
+    case FUSE_GETATTR:
+      {
+        // No caching of the size, the backing file may grow like a timeshift segment
+        struct fuse_attr_out reply;
+        memset(&reply, 0, sizeof(reply));
+        fstat(g_backing, &g_backingStat);
+        FillAttributes(&reply.attr, in->nodeid);
+        Reply(in->unique, 0, &reply, sizeof(reply));
+        break;
+      }
+    case FUSE_OPEN:
+    case FUSE_OPENDIR:
+      {
+        struct fuse_open_out reply;
+        memset(&reply, 0, sizeof(reply));
+        if (in->opcode == FUSE_OPEN && g_direct)
+          reply.open_flags = FOPEN_DIRECT_IO;
+        Reply(in->unique, 0, &reply, sizeof(reply));
+        break;
+      }
+    case FUSE_READ:
+      Read(in->unique, (const struct fuse_read_in*) body, out);
+      break;
+    case FUSE_FORGET:
+    case FUSE_BATCH_FORGET:
+      break;
+    case FUSE_RELEASE:
+    case FUSE_RELEASEDIR:
+    case FUSE_FLUSH:
+      Reply(in->unique, 0, NULL, 0);
+      break;
+    case FUSE_DESTROY:
+      PrintStatistics();
+      Reply(in->unique, 0, NULL, 0);
+      exit(0);
+    default:
+      Reply(in->unique, -ENOSYS, NULL, 0);
+      break;
+    }
+  }
+  return NULL;
+}
+
+int main(int argc, char** argv)
+{
+  pthread_t threads[MAX_THREADS];
+  char options[128];
+  int count;
+  int i;
+
+  if (argc < 6)
+  {
+    fprintf(stderr, "usage: %s <mount point> <backing file> <latency us> <direct io 0|1> <threads>\n", argv[0]);
+    return 2;
+  }
+  g_backing = open(argv[2], O_RDONLY | O_CLOEXEC);
+  if (g_backing < 0 || fstat(g_backing, &g_backingStat) != 0)
+  {
+    perror(argv[2]);
+    return 1;
+  }
+  g_latency = atoi(argv[3]);
+  g_direct = atoi(argv[4]);
+  count = atoi(argv[5]);
+  if (count < 1)
+    count = 1;
+  if (count > MAX_THREADS)
+    count = MAX_THREADS;
+
+  g_dev = open("/dev/fuse", O_RDWR | O_CLOEXEC);
+  if (g_dev < 0)
+  {
+    perror("/dev/fuse");
+    return 1;
+  }
+  snprintf(options, sizeof(options), "fd=%d,rootmode=40000,user_id=%d,group_id=%d,allow_other",
+    g_dev, (int) getuid(), (int) getgid());
+  if (mount("slowfs", argv[1], "fuse.slowfs", MS_NOSUID | MS_NODEV, options) != 0)
+  {
+    perror("mount");
+    return 1;
+  }
+
+  for (i = 0; i < count; i++)
+    pthread_create(&threads[i], NULL, Worker, NULL);
+  pthread_join(threads[0], NULL);
+  return 0;
+}
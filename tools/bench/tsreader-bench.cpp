@@ -0,0 +1,99 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+/*
+ * Reads a file front to back through one of the local file backends of the tsreader, in the
+ * block size Kodi's demuxer asks for, and prints the throughput.
+ *
+ * usage: tsreader-bench <blocking|uring|mmap> <file> <MB>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "p8-platform/util/timeutils.h"
+#include "client.h"
+#include "LocalFileBackend.h"
+#include "MappedFileBackend.h"
+#include "UringFileBackend.h"
+
+using namespace ArgusTV;
+
+// What the demuxer reads at once: 348 transport stream packets
+#define BENCH_BLOCK (188 * 348)
+
+ADDON::CHelper_libXBMC_addon* XBMC = new ADDON::CHelper_libXBMC_addon;
+
+static CFileBackend* CreateBackend(const char* pszKind)
+{
+  if (strcmp(pszKind, "blocking") == 0)
+    return new CLocalFileBackend();
+  if (strcmp(pszKind, "mmap") == 0)
+    return new CMappedFileBackend();
+#if defined(HAVE_IO_URING)
+  if (strcmp(pszKind, "uring") == 0)
+    return new CUringFileBackend();
+#endif
+  return NULL;
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 4)
+  {
+    fprintf(stderr, "usage: %s <blocking|uring|mmap> <file> <MB>\n", argv[0]);
+    return 2;
+  }
+
+  CFileBackend* backend = CreateBackend(argv[1]);
+  if (!backend)
+  {
+    fprintf(stderr, "%s: backend %s is not available\n", argv[0], argv[1]);
+    return 2;
+  }
+  if (!backend->Open(argv[2]))
+  {
+    fprintf(stderr, "%s: can not open %s\n", argv[0], argv[2]);
+    delete backend;
+    return 1;
+  }
+
+  int64_t total = (int64_t) atol(argv[3]) * 1024 * 1024;
+  int64_t done = 0;
+  std::vector<unsigned char> buffer(BENCH_BLOCK);
+  uint64_t start = P8PLATFORM::GetTimeMs();
+  while (done < total)
+  {
+    unsigned long read = backend->Read(&buffer[0], BENCH_BLOCK);
+    if (read == 0)
+      break;
+    done += read;
+  }
+  double seconds = (P8PLATFORM::GetTimeMs() - start) / 1000.0;
+  if (seconds <= 0)
+    seconds = 0.001;
+
+  printf("%-8s %7.1f MB/s (%lld MB in %.2f s)\n", argv[1], done / 1048576.0 / seconds, (long long) (done >> 20), seconds);
+  backend->Close();
+  delete backend;
+  return 0;
+}